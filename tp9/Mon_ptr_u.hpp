@@ -5,36 +5,169 @@
 #ifndef TP9_MON_PTR_U_HPP
 #define TP9_MON_PTR_U_HPP
 
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Destructeur par défaut de Mon_ptr_u : delete
+template<class T>
+struct Mon_delete {
+    void operator()(T *ptr) const;
+};
+
+// Pour un tableau (Mon_ptr_u<T[]>) : delete[]
 template<class T>
+struct Mon_delete<T[]> {
+    void operator()(T *ptr) const;
+};
+
+/* Conserve le destructeur D à côté du pointeur P (T *, ou le mot d'un tagged_ptr).
+ * Un destructeur de type classe est une base : s'il est vide (Mon_delete, foncteur sans état),
+ * il n'occupe aucun octet ("empty base optimization"). Un pointeur de fonction est un membre.
+ */
+template<class P, class D, bool = std::is_class<D>::value>
+struct Mon_ptr_holder : D {
+    P ptr;
+
+    Mon_ptr_holder(P ptr, const D &d);
+
+    D &deleter();
+};
+
+template<class P, class D>
+struct Mon_ptr_holder<P, D, false> {
+    P ptr;
+    D d;
+
+    Mon_ptr_holder(P ptr, const D &d);
+
+    D &deleter();
+};
+
+template<class T, class Deleter = Mon_delete<T> >
 class Mon_ptr_u {
 private:
-    T *ptr;
+    Mon_ptr_holder<T *, Deleter> h;
+
+    // Détruit l'objet possédé par Deleter puis possède ptr
+    void reset(T *ptr);
+
 public:
+    /* Comme std::unique_ptr : sans destructeur explicite, Deleter() doit être utilisable.
+     * Un pointeur de fonction construit par défaut est nul, il faut donc le passer.
+     */
+    template<class D = Deleter, class = typename std::enable_if<!std::is_pointer<D>::value>::type>
     explicit Mon_ptr_u(T *ptr);
 
-    explicit Mon_ptr_u(Mon_ptr_u<T> const &p) = delete;
-    explicit Mon_ptr_u(Mon_ptr_u<T> &p) = delete;
+    Mon_ptr_u(T *ptr, const Deleter &d);
+
+    explicit Mon_ptr_u(Mon_ptr_u<T, Deleter> const &p) = delete;
+    explicit Mon_ptr_u(Mon_ptr_u<T, Deleter> &p) = delete;
+
+    // Le déplacement transfère la possession : p devient nul
+    Mon_ptr_u(Mon_ptr_u<T, Deleter> &&p) noexcept;
 
     bool operator==(const Mon_ptr_u &rhs) const;
 
     bool operator!=(const Mon_ptr_u &rhs) const;
 
-    virtual ~Mon_ptr_u();
+    // Non virtuel : pas de table virtuelle, sizeof(Mon_ptr_u<T>) == sizeof(T *)
+    ~Mon_ptr_u();
 
     //Mon_ptr_u<T>& operator=(Mon_ptr_u<T> p);
-    Mon_ptr_u<T>& operator=(Mon_ptr_u<T> &p);
+    // Transfert de possession depuis p, qui devient nul
+    Mon_ptr_u<T, Deleter> &operator=(Mon_ptr_u<T, Deleter> &p);
+
+    Mon_ptr_u<T, Deleter> &operator=(Mon_ptr_u<T, Deleter> &&p) noexcept;
 
     T *release();
 
-    void echange(Mon_ptr_u<T> &p);
+    // Échange pointeurs et destructeurs (non atomique, cf. atomic_mon_ptr)
+    void echange(Mon_ptr_u<T, Deleter> &p);
 
     explicit operator bool() const;
 
     T operator*() const;
 
     T *operator->() const;
+
+    // Le pointeur possédé, sans en transférer la possession (nullptr si vide)
+    T *get() const;
+
+    Deleter &get_deleter();
 };
 
+/* Mon_ptr_u<T[]> : possède un tableau alloué par new[], détruit par delete[].
+ * operator[] remplace * et -> ; pas de conversion depuis un Mon_ptr_u<T>.
+ */
+template<class T, class Deleter>
+class Mon_ptr_u<T[], Deleter> {
+private:
+    Mon_ptr_holder<T *, Deleter> h;
+
+    // Détruit le tableau possédé par Deleter puis possède ptr
+    void reset(T *ptr);
+
+public:
+    // Comme pour Mon_ptr_u<T> : un destructeur pointeur de fonction doit être passé
+    template<class D = Deleter, class = typename std::enable_if<!std::is_pointer<D>::value>::type>
+    explicit Mon_ptr_u(T *ptr);
+
+    Mon_ptr_u(T *ptr, const Deleter &d);
+
+    Mon_ptr_u(Mon_ptr_u<T[], Deleter> const &p) = delete;
+
+    Mon_ptr_u(Mon_ptr_u<T[], Deleter> &&p) noexcept;
+
+    ~Mon_ptr_u();
+
+    Mon_ptr_u<T[], Deleter> &operator=(Mon_ptr_u<T[], Deleter> const &p) = delete;
+
+    Mon_ptr_u<T[], Deleter> &operator=(Mon_ptr_u<T[], Deleter> &&p) noexcept;
+
+    T *release();
+
+    void echange(Mon_ptr_u<T[], Deleter> &p);
+
+    T *get() const;
+
+    explicit operator bool() const;
+
+    // Pas de vérification de l'indice, comme pour un tableau
+    T &operator[](std::size_t i) const;
+
+    Deleter &get_deleter();
+};
+
+/* Étiquette de make_mon_ptr<T[]> : éléments initialisés par défaut (new T[n])
+ * et non par valeur (new T[n]()). Pour un type trivial, la mémoire n'est pas
+ * mise à zéro : les éléments ont une valeur indéterminée jusqu'à leur écriture.
+ */
+struct Mon_default_init_t {
+};
+
+constexpr Mon_default_init_t Mon_default_init = Mon_default_init_t();
+
+/* Fabriques : une seule allocation, possédée dès sa création.
+ * - make_mon_ptr<T>(args...) : new T(args...)
+ * - make_mon_ptr<T[]>(n) : new T[n](), éléments initialisés par valeur (zéro pour un int)
+ * - make_mon_ptr<T[]>(n, Mon_default_init) : new T[n], éléments initialisés par défaut
+ * make_mon_ptr<T[N]> n'existe pas : la taille est celle passée à l'exécution.
+ */
+template<class T, class... Args>
+typename std::enable_if<!std::is_array<T>::value, Mon_ptr_u<T> >::type make_mon_ptr(Args &&... args);
+
+template<class T>
+typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0, Mon_ptr_u<T> >::type
+make_mon_ptr(std::size_t n);
+
+template<class T>
+typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0, Mon_ptr_u<T> >::type
+make_mon_ptr(std::size_t n, Mon_default_init_t);
+
+template<class T, class... Args>
+typename std::enable_if<std::extent<T>::value != 0>::type make_mon_ptr(Args &&...) = delete;
+
 #include "Mon_ptr_u.tcc"
 
 
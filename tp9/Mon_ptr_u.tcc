@@ -7,61 +7,222 @@
 
 
 template<class T>
-Mon_ptr_u<T>::~Mon_ptr_u() {
+void Mon_delete<T>::operator()(T *ptr) const {
     delete ptr;
 }
 
 template<class T>
-T *Mon_ptr_u<T>::release() {
-    T *t = ptr;
-    ptr = nullptr;
+void Mon_delete<T[]>::operator()(T *ptr) const {
+    delete[] ptr;
+}
+
+template<class P, class D, bool IsClass>
+Mon_ptr_holder<P, D, IsClass>::Mon_ptr_holder(P ptr, const D &d) : D(d), ptr(ptr) {}
+
+template<class P, class D, bool IsClass>
+D &Mon_ptr_holder<P, D, IsClass>::deleter() {
+    return *this;
+}
+
+template<class P, class D>
+Mon_ptr_holder<P, D, false>::Mon_ptr_holder(P ptr, const D &d) : ptr(ptr), d(d) {}
+
+template<class P, class D>
+D &Mon_ptr_holder<P, D, false>::deleter() {
+    return d;
+}
+
+template<class T, class Deleter>
+void Mon_ptr_u<T, Deleter>::reset(T *ptr) {
+    T *old = h.ptr;
+    h.ptr = ptr;
+    if (old != nullptr) {
+        h.deleter()(old);
+    }
+}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter>::~Mon_ptr_u() {
+    if (h.ptr != nullptr) {
+        h.deleter()(h.ptr);
+    }
+}
+
+template<class T, class Deleter>
+T *Mon_ptr_u<T, Deleter>::release() {
+    T *t = h.ptr;
+    h.ptr = nullptr;
     return t;
 }
 
 
-template<class T>
-bool Mon_ptr_u<T>::operator==(const Mon_ptr_u &rhs) const {
-    return ptr == rhs.ptr;
+template<class T, class Deleter>
+bool Mon_ptr_u<T, Deleter>::operator==(const Mon_ptr_u &rhs) const {
+    return h.ptr == rhs.h.ptr;
 }
 
-template<class T>
-bool Mon_ptr_u<T>::operator!=(const Mon_ptr_u &rhs) const {
+template<class T, class Deleter>
+bool Mon_ptr_u<T, Deleter>::operator!=(const Mon_ptr_u &rhs) const {
     return !(rhs == *this);
 }
 
-template<class T>
-void Mon_ptr_u<T>::echange(Mon_ptr_u<T> &p) {
-    const Mon_ptr_u<T> &t = p;
-    p.ptr = this->ptr;
-    this->ptr = t.ptr;
+template<class T, class Deleter>
+void Mon_ptr_u<T, Deleter>::echange(Mon_ptr_u<T, Deleter> &p) {
+    // Une copie du pointeur, et non une référence vers p, qui est écrasé juste après
+    T *t = p.h.ptr;
+    p.h.ptr = h.ptr;
+    h.ptr = t;
+    Deleter d = p.get_deleter();
+    p.get_deleter() = get_deleter();
+    get_deleter() = d;
 }
 
-template<class T>
-Mon_ptr_u<T>::operator bool() const {
-    return ptr != nullptr;
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter>::operator bool() const {
+    return h.ptr != nullptr;
 }
 
-template<class T>
-T Mon_ptr_u<T>::operator*() const {
-    return *ptr;
+template<class T, class Deleter>
+T Mon_ptr_u<T, Deleter>::operator*() const {
+    return *h.ptr;
 }
 
-template<class T>
-T *Mon_ptr_u<T>::operator->() const {
-    return ptr;
+template<class T, class Deleter>
+T *Mon_ptr_u<T, Deleter>::operator->() const {
+    return h.ptr;
 }
 
-template<class T>
-Mon_ptr_u<T>::Mon_ptr_u(T *ptr):ptr(ptr) {}
+template<class T, class Deleter>
+T *Mon_ptr_u<T, Deleter>::get() const {
+    return h.ptr;
+}
 
-template<class T>
-Mon_ptr_u<T>& Mon_ptr_u<T>::operator=(Mon_ptr_u<T> &p) {
+template<class T, class Deleter>
+Deleter &Mon_ptr_u<T, Deleter>::get_deleter() {
+    return h.deleter();
+}
+
+template<class T, class Deleter>
+template<class D, class>
+Mon_ptr_u<T, Deleter>::Mon_ptr_u(T *ptr):h(ptr, Deleter()) {}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter>::Mon_ptr_u(T *ptr, const Deleter &d):h(ptr, d) {}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter>::Mon_ptr_u(Mon_ptr_u<T, Deleter> &&p) noexcept : h(p.release(), p.get_deleter()) {}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter> &Mon_ptr_u<T, Deleter>::operator=(Mon_ptr_u<T, Deleter> &p) {
     if (p == *this) {
         return *this;
     }
-    this->ptr = p.release();
+    // L'ancien objet est détruit, et non plus perdu
+    reset(p.release());
+    h.deleter() = p.get_deleter();
+    return *this;
+}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter> &Mon_ptr_u<T, Deleter>::operator=(Mon_ptr_u<T, Deleter> &&p) noexcept {
+    if (&p != this) {
+        reset(p.release());
+        h.deleter() = p.get_deleter();
+    }
+    return *this;
+}
+
+// ========== Mon_ptr_u<T[]> ==========
+
+template<class T, class Deleter>
+void Mon_ptr_u<T[], Deleter>::reset(T *ptr) {
+    T *old = h.ptr;
+    h.ptr = ptr;
+    if (old != nullptr) {
+        h.deleter()(old);
+    }
+}
+
+template<class T, class Deleter>
+template<class D, class>
+Mon_ptr_u<T[], Deleter>::Mon_ptr_u(T *ptr):h(ptr, Deleter()) {}
+
+template<class T, class Deleter>
+Mon_ptr_u<T[], Deleter>::Mon_ptr_u(T *ptr, const Deleter &d):h(ptr, d) {}
+
+template<class T, class Deleter>
+Mon_ptr_u<T[], Deleter>::Mon_ptr_u(Mon_ptr_u<T[], Deleter> &&p) noexcept : h(p.release(), p.get_deleter()) {}
+
+template<class T, class Deleter>
+Mon_ptr_u<T[], Deleter>::~Mon_ptr_u() {
+    if (h.ptr != nullptr) {
+        h.deleter()(h.ptr);
+    }
+}
+
+template<class T, class Deleter>
+Mon_ptr_u<T[], Deleter> &Mon_ptr_u<T[], Deleter>::operator=(Mon_ptr_u<T[], Deleter> &&p) noexcept {
+    if (&p != this) {
+        reset(p.release());
+        h.deleter() = p.get_deleter();
+    }
     return *this;
 }
 
+template<class T, class Deleter>
+T *Mon_ptr_u<T[], Deleter>::release() {
+    T *t = h.ptr;
+    h.ptr = nullptr;
+    return t;
+}
+
+template<class T, class Deleter>
+void Mon_ptr_u<T[], Deleter>::echange(Mon_ptr_u<T[], Deleter> &p) {
+    T *t = p.h.ptr;
+    p.h.ptr = h.ptr;
+    h.ptr = t;
+    Deleter d = p.get_deleter();
+    p.get_deleter() = get_deleter();
+    get_deleter() = d;
+}
+
+template<class T, class Deleter>
+T *Mon_ptr_u<T[], Deleter>::get() const {
+    return h.ptr;
+}
+
+template<class T, class Deleter>
+Mon_ptr_u<T[], Deleter>::operator bool() const {
+    return h.ptr != nullptr;
+}
+
+template<class T, class Deleter>
+T &Mon_ptr_u<T[], Deleter>::operator[](std::size_t i) const {
+    return h.ptr[i];
+}
+
+template<class T, class Deleter>
+Deleter &Mon_ptr_u<T[], Deleter>::get_deleter() {
+    return h.deleter();
+}
+
+// ========== make_mon_ptr ==========
+
+template<class T, class... Args>
+typename std::enable_if<!std::is_array<T>::value, Mon_ptr_u<T> >::type make_mon_ptr(Args &&... args) {
+    return Mon_ptr_u<T>(new T(std::forward<Args>(args)...));
+}
+
+template<class T>
+typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0, Mon_ptr_u<T> >::type
+make_mon_ptr(std::size_t n) {
+    return Mon_ptr_u<T>(new typename std::remove_extent<T>::type[n]());
+}
+
+template<class T>
+typename std::enable_if<std::is_array<T>::value && std::extent<T>::value == 0, Mon_ptr_u<T> >::type
+make_mon_ptr(std::size_t n, Mon_default_init_t) {
+    return Mon_ptr_u<T>(new typename std::remove_extent<T>::type[n]);
+}
 
-#endif //TP9_MON_PTR_U_TCC
\ No newline at end of file
+#endif //TP9_MON_PTR_U_TCC
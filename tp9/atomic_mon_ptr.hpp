@@ -0,0 +1,63 @@
+#ifndef TP9_ATOMIC_MON_PTR_HPP
+#define TP9_ATOMIC_MON_PTR_HPP
+
+#include <atomic>
+#include <type_traits>
+#include "Mon_ptr_u.hpp"
+
+/* atomic_mon_ptr<T> : un emplacement partagé entre threads qui possède au plus un T.
+ *
+ * La possession passe d'un Mon_ptr_u à l'emplacement, et inversement, par une seule
+ * opération atomique sur un std::atomic<T *> (sans verrou sur les plateformes usuelles) :
+ * à tout instant un objet n'a qu'un seul propriétaire, il ne peut donc être ni perdu
+ * ni détruit deux fois, même si plusieurs threads agissent sur l'emplacement.
+ *
+ * - exchange(p) : installe p et rend l'ancien contenu
+ * - take() : vide l'emplacement et rend son contenu
+ * - compare_exchange(expected, p) : installe p seulement si l'emplacement contient expected
+ *
+ * Les opérations ont une sémantique acquire/release : le thread qui reçoit un objet voit
+ * toutes les écritures faites dessus par le thread qui l'a déposé.
+ * Seul l'emplacement est partagé : l'objet, une fois repris, appartient à un seul thread.
+ * Deleter doit être sans état (seul le pointeur est rangé dans l'emplacement).
+ */
+
+template<class T, class Deleter = Mon_delete<T> >
+class atomic_mon_ptr {
+private:
+    static_assert(std::is_empty<Deleter>::value, "le destructeur d'un atomic_mon_ptr doit être sans état");
+
+    std::atomic<T *> ptr;
+
+public:
+    // Emplacement vide
+    atomic_mon_ptr();
+
+    explicit atomic_mon_ptr(Mon_ptr_u<T, Deleter> &&p);
+
+    atomic_mon_ptr(atomic_mon_ptr<T, Deleter> const &p) = delete;
+
+    atomic_mon_ptr<T, Deleter> &operator=(atomic_mon_ptr<T, Deleter> const &p) = delete;
+
+    // Détruit le contenu ; aucun autre thread ne doit plus utiliser l'emplacement
+    ~atomic_mon_ptr();
+
+    Mon_ptr_u<T, Deleter> exchange(Mon_ptr_u<T, Deleter> &&p);
+
+    // exchange avec un pointeur nul
+    Mon_ptr_u<T, Deleter> take();
+
+    /* Si l'emplacement contient expected : y installe l'objet de p, p reçoit l'ancien
+     * contenu (expected), et retourne true. Sinon : expected reçoit le contenu actuel,
+     * p est inchangé, et retourne false. expected ne sert qu'à la comparaison,
+     * il ne doit pas être déréférencé (l'objet a pu être repris et détruit).
+     */
+    bool compare_exchange(T *&expected, Mon_ptr_u<T, Deleter> &p);
+
+    bool is_lock_free() const;
+};
+
+#include "atomic_mon_ptr.tcc"
+
+
+#endif //TP9_ATOMIC_MON_PTR_HPP
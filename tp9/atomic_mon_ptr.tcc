@@ -0,0 +1,47 @@
+#ifndef TP9_ATOMIC_MON_PTR_TCC
+#define TP9_ATOMIC_MON_PTR_TCC
+
+
+template<class T, class Deleter>
+atomic_mon_ptr<T, Deleter>::atomic_mon_ptr() : ptr{nullptr} {}
+
+template<class T, class Deleter>
+atomic_mon_ptr<T, Deleter>::atomic_mon_ptr(Mon_ptr_u<T, Deleter> &&p) : ptr{p.release()} {}
+
+template<class T, class Deleter>
+atomic_mon_ptr<T, Deleter>::~atomic_mon_ptr() {
+    T *t = ptr.load(std::memory_order_acquire);
+    if (t != nullptr) {
+        Deleter()(t);
+    }
+}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter> atomic_mon_ptr<T, Deleter>::exchange(Mon_ptr_u<T, Deleter> &&p) {
+    return Mon_ptr_u<T, Deleter>(ptr.exchange(p.release(), std::memory_order_acq_rel));
+}
+
+template<class T, class Deleter>
+Mon_ptr_u<T, Deleter> atomic_mon_ptr<T, Deleter>::take() {
+    return Mon_ptr_u<T, Deleter>(ptr.exchange(nullptr, std::memory_order_acq_rel));
+}
+
+template<class T, class Deleter>
+bool atomic_mon_ptr<T, Deleter>::compare_exchange(T *&expected, Mon_ptr_u<T, Deleter> &p) {
+    T *desired = p.get();
+    if (!ptr.compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return false;
+    }
+    // L'emplacement possède désormais desired, p reprend l'ancien contenu
+    p.release();
+    p = Mon_ptr_u<T, Deleter>(expected);
+    return true;
+}
+
+template<class T, class Deleter>
+bool atomic_mon_ptr<T, Deleter>::is_lock_free() const {
+    return ptr.is_lock_free();
+}
+
+
+#endif //TP9_ATOMIC_MON_PTR_TCC
@@ -0,0 +1,71 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/* Petit harnais de mesure partagé par les benchmarks du dossier bench.
+ *
+ * Chaque benchmark est un exécutable indépendant qui affiche une ligne
+ * par mesure : nom, nombre d'itérations, temps moyen par itération.
+ */
+
+namespace bench {
+
+    /* Empêche le compilateur de supprimer un calcul dont le résultat
+     * n'est pas utilisé (sans quoi on mesurerait une boucle vide).
+     */
+    template<class T>
+    inline void doNotOptimize(const T &value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    // Force le compilateur à considérer que la mémoire a pu être lue/écrite
+    inline void clobberMemory() {
+        asm volatile("" : : : "memory");
+    }
+
+    // Nombre d'itérations : premier argument de la ligne de commande, sinon la valeur par défaut
+    inline long iterations(int argc, char **argv, long default_iterations) {
+        if (argc > 1) {
+            return std::atol(argv[1]);
+        }
+        return default_iterations;
+    }
+
+    /* Appelle f(i) pour i de 0 à n - 1 et affiche le temps moyen par appel.
+     * Retourne ce temps en nanosecondes.
+     */
+    template<class F>
+    double run(const char *name, long n, F f) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < n; i++) {
+            f(i);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / (double) n;
+        std::printf("%-48s %12ld it %10.2f ns/it\n", name, n, ns);
+        return ns;
+    }
+
+    /* Pour les traitements par lots : chaque appel f() traite elements éléments.
+     * Appelle f passes fois et affiche le temps moyen par élément.
+     */
+    template<class F>
+    double runBatch(const char *name, long passes, long elements, F f) {
+        auto start = std::chrono::steady_clock::now();
+        for (long p = 0; p < passes; p++) {
+            f();
+            clobberMemory();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / (double) (passes * elements);
+        std::printf("%-48s %12ld elt %10.3f ns/elt %9.1f Melt/s\n", name, elements, ns, 1e3 / ns);
+        return ns;
+    }
+
+}
+
+
+#endif
@@ -0,0 +1,225 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "bench.hpp"
+#include "../Mon_ptr_u.hpp"
+#include "../atomic_mon_ptr.hpp"
+
+/* Passage de possession entre threads : atomic_mon_ptr<Item> comparé à un Mon_ptr_u
+ * protégé par un std::mutex.
+ *
+ * - vérifications : echange, exchange, take, compare_exchange sur un seul thread
+ * - stress : P producteurs déposent des objets numérotés dans S emplacements
+ *   (compare_exchange sur un emplacement vide), C consommateurs les reprennent (take) ;
+ *   chaque objet doit être reçu une fois et détruit une fois
+ * - débit sans concurrence : exchange puis take sur un seul thread
+ * - débit producteur / consommateur : deux threads, un emplacement
+ *
+ * Les attentes actives cèdent le processeur (yield) : sur une machine à un seul coeur,
+ * les deux threads se succèdent au lieu de s'exécuter en parallèle.
+ */
+
+struct Item {
+    static std::atomic<long> alive;
+    long id;
+
+    explicit Item(long id) : id{id} {
+        alive++;
+    }
+
+    ~Item() {
+        alive--;
+    }
+};
+
+std::atomic<long> Item::alive{0};
+
+typedef Mon_ptr_u<Item> Ptr;
+
+// Le même emplacement, protégé par un verrou
+class locked_mon_ptr {
+private:
+    std::mutex m;
+    Ptr p{nullptr};
+
+public:
+    Ptr exchange(Ptr &&q) {
+        std::lock_guard<std::mutex> lock(m);
+        p.echange(q);
+        return std::move(q);
+    }
+
+    Ptr take() {
+        return exchange(Ptr(nullptr));
+    }
+
+    bool compare_exchange(Item *&expected, Ptr &q) {
+        std::lock_guard<std::mutex> lock(m);
+        if (p.get() != expected) {
+            expected = p.get();
+            return false;
+        }
+        p.echange(q);
+        return true;
+    }
+};
+
+static void fail(const char *what) {
+    std::printf("%s incorrect\n", what);
+    std::exit(1);
+}
+
+static void check() {
+    {
+        Ptr a(new Item{1}), b(new Item{2});
+        a.echange(b);
+        if (a->id != 2 || b->id != 1) {
+            fail("echange");
+        }
+        atomic_mon_ptr<Item> slot(std::move(a));
+        Ptr old = slot.exchange(std::move(b));
+        if (a || b || old->id != 2) {
+            fail("exchange");
+        }
+        Item *expected = nullptr;
+        Ptr c(new Item{3});
+        if (slot.compare_exchange(expected, c) || expected == nullptr || expected->id != 1 || c->id != 3) {
+            fail("compare_exchange en échec");
+        }
+        if (!slot.compare_exchange(expected, c) || c->id != 1) {
+            fail("compare_exchange réussi");
+        }
+        Ptr taken = slot.take();
+        if (taken->id != 3 || slot.take()) {
+            fail("take");
+        }
+        // Détruit avec l'emplacement
+        atomic_mon_ptr<Item> other(Ptr(new Item{4}));
+    }
+    if (Item::alive != 0) {
+        fail("destruction");
+    }
+}
+
+template<class Slot>
+static void stress(const char *name, long items, int producers, int consumers, int slots) {
+    std::vector<Slot> slot(slots);
+    std::vector<std::atomic<int> > received(items);
+    for (std::atomic<int> &r : received) {
+        r = 0;
+    }
+    std::atomic<long> consumed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < producers; t++) {
+        threads.push_back(std::thread([&, t]() {
+            for (long id = t; id < items; id += producers) {
+                Ptr p(new Item{id});
+                for (long s = id;; s++) {
+                    Item *expected = nullptr;
+                    if (slot[s % slots].compare_exchange(expected, p)) {
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+    for (int t = 0; t < consumers; t++) {
+        threads.push_back(std::thread([&, t]() {
+            for (long s = t; consumed.load() < items; s++) {
+                Ptr p = slot[s % slots].take();
+                if (p) {
+                    received[p->id]++;
+                    consumed++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (long id = 0; id < items; id++) {
+        if (received[id] != 1) {
+            std::printf("%s : objet %ld reçu %d fois\n", name, id, received[id].load());
+            std::exit(1);
+        }
+    }
+    if (Item::alive != 0) {
+        std::printf("%s : %ld objets non détruits\n", name, Item::alive.load());
+        std::exit(1);
+    }
+    std::printf("%-48s %ld objets, %d producteurs, %d consommateurs : ok\n", name, items, producers, consumers);
+}
+
+template<class Slot>
+static void uncontended(const char *name, long n) {
+    Slot slot;
+    Ptr p(new Item{0});
+    bench::run(name, n, [&](long) {
+        slot.exchange(std::move(p));
+        p = slot.take();
+    });
+    if (!p || p->id != 0) {
+        fail(name);
+    }
+}
+
+template<class Slot>
+static void handOff(const char *name, long n) {
+    Slot slot;
+    std::vector<Ptr> items;
+    for (long i = 0; i < n; i++) {
+        items.push_back(Ptr(new Item{i}));
+    }
+    long sum = 0;
+    bench::runBatch(name, 1, n, [&]() {
+        std::thread consumer([&]() {
+            for (long received = 0; received < n;) {
+                Ptr p = slot.take();
+                if (p) {
+                    sum += p->id;
+                    received++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for (long i = 0; i < n; i++) {
+            while (true) {
+                Item *expected = nullptr;
+                if (slot.compare_exchange(expected, items[i])) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+    });
+    if (sum != n * (n - 1) / 2) {
+        fail(name);
+    }
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 1000000);
+    check();
+
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("%u coeur(s), atomic_mon_ptr sans verrou : %s\n", cores,
+                atomic_mon_ptr<Item>().is_lock_free() ? "oui" : "non");
+    stress<atomic_mon_ptr<Item> >("stress atomic_mon_ptr", n / 4, 4, 4, 8);
+    stress<atomic_mon_ptr<Item> >("stress atomic_mon_ptr, un emplacement", n / 4, 3, 2, 1);
+    stress<locked_mon_ptr>("stress Mon_ptr_u + mutex", n / 4, 4, 4, 8);
+
+    uncontended<atomic_mon_ptr<Item> >("exchange + take, atomic_mon_ptr", n * 10);
+    uncontended<locked_mon_ptr>("exchange + take, Mon_ptr_u + mutex", n * 10);
+    handOff<atomic_mon_ptr<Item> >("producteur -> consommateur, atomic_mon_ptr", n);
+    handOff<locked_mon_ptr>("producteur -> consommateur, Mon_ptr_u + mutex", n);
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "bench.hpp"
+#include "../intrusive_ptr.hpp"
+#include "../optional.hpp"
+
+/* Copie et destruction de n pointeurs partagés vers n objets distincts, pris dans un
+ * ordre aléatoire (chaque accès sort du cache) :
+ *
+ * - std::shared_ptr(new T) : l'objet et le bloc de contrôle sont deux allocations
+ * - std::make_shared : une allocation, mais un handle de deux pointeurs
+ * - lib::intrusive_ptr, compteur atomique puis non atomique : le compteur est dans l'objet
+ * - lib::optional<std::shared_ptr> : l'optionnel alloue en plus un shared_ptr par copie
+ * - lib::optional<lib::intrusive_ptr> : l'optionnel n'est que le pointeur
+ *
+ * copie : push_back de chaque pointeur dans un vecteur puis lecture de l'objet
+ * destruction : destruction de ce vecteur (les objets restent partagés par la source)
+ * Défauts de cache par élément si les compteurs matériels sont disponibles (perf_event_open).
+ */
+
+struct PlainPayload {
+    long v[4];
+
+    explicit PlainPayload(long x) : v{x, x + 1, x + 2, x + 3} {}
+};
+
+static long alive = 0;
+
+struct Payload : lib::ref_counted<Payload> {
+    long v[4];
+
+    explicit Payload(long x) : v{x, x + 1, x + 2, x + 3} {
+        alive++;
+    }
+
+    Payload(const Payload &other)
+            : lib::ref_counted<Payload>(other), v{other.v[0], other.v[1], other.v[2], other.v[3]} {
+        alive++;
+    }
+
+    ~Payload() {
+        alive--;
+    }
+};
+
+struct AtomicPayload : lib::atomic_ref_counted<AtomicPayload> {
+    long v[4];
+
+    explicit AtomicPayload(long x) : v{x, x + 1, x + 2, x + 3} {}
+};
+
+static_assert(sizeof(lib::intrusive_ptr<Payload>) == sizeof(Payload *), "un pointeur");
+static_assert(sizeof(lib::optional<lib::intrusive_ptr<const AtomicPayload> >) == sizeof(AtomicPayload *),
+              "optionnel sans indirection");
+static_assert(sizeof(std::shared_ptr<PlainPayload>) == 2 * sizeof(PlainPayload *), "objet et bloc de contrôle");
+static_assert(sizeof(AtomicPayload) == sizeof(Payload), "compteur atomique de même taille");
+
+static void fail(const char *what) {
+    std::printf("intrusive_ptr : %s incorrect\n", what);
+    std::exit(1);
+}
+
+static Payload *twice(const lib::intrusive_ptr<const Payload> &p) {
+    return new Payload(p->v[0] * 2);
+}
+
+static void check() {
+    {
+        lib::intrusive_ptr<Payload> a = lib::make_intrusive<Payload>(1);
+        lib::intrusive_ptr<const Payload> b(a);
+        lib::intrusive_ptr<const Payload> c;
+        c = b;
+        c = c;
+        if (a.use_count() != 3 || c->v[0] != 1 || c.get() != a.get() || alive != 1) {
+            fail("copie");
+        }
+        lib::intrusive_ptr<const Payload> d(std::move(c));
+        if (c || a.use_count() != 3) {
+            fail("déplacement");
+        }
+        a = lib::make_intrusive<Payload>(2);
+        if (a.use_count() != 1 || b.use_count() != 2 || alive != 2) {
+            fail("affectation");
+        }
+        // Copie d'un objet : nouveau compteur
+        lib::intrusive_ptr<Payload> e = lib::make_intrusive<Payload>(*a);
+        if (e.use_count() != 1 || a.use_count() != 1) {
+            fail("copie de l'objet");
+        }
+
+        typedef lib::optional<lib::intrusive_ptr<const Payload> > Opt;
+        Opt o = Opt::of(b);
+        Opt copy = o;
+        if (b.use_count() != 4 || !copy || copy.orElseThrow().get() != b.get()) {
+            fail("optional<intrusive_ptr>");
+        }
+        if (Opt::of(lib::intrusive_ptr<const Payload>()).isPresent() || Opt::ofNullable(nullptr) || Opt::empty()) {
+            fail("optional<intrusive_ptr> vide");
+        }
+        if (o.filter([](const lib::intrusive_ptr<const Payload> &p) { return p->v[0] == 2; })
+            || !o.filter([](const lib::intrusive_ptr<const Payload> &p) { return p->v[0] == 1; })) {
+            fail("filter");
+        }
+        if (o.map(twice).orElseThrow().v[0] != 2 || Opt::empty().map(twice)) {
+            fail("map");
+        }
+        if (Opt::empty().orElse(d).get() != b.get()) {
+            fail("orElse");
+        }
+    }
+    if (alive != 0) {
+        fail("destruction");
+    }
+}
+
+// Copies et destructions concurrentes d'un même objet
+static void stress(long n) {
+    lib::intrusive_ptr<const AtomicPayload> shared = lib::make_intrusive<const AtomicPayload>(7);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([&]() {
+            std::vector<lib::intrusive_ptr<const AtomicPayload> > copies(16);
+            for (long i = 0; i < n; i++) {
+                copies[i % 16] = shared;
+            }
+        }));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    if (shared.use_count() != 1) {
+        fail("compteur atomique");
+    }
+}
+
+// Défauts de cache du thread courant, -1 si les compteurs matériels sont indisponibles
+class cache_misses {
+private:
+    int fd;
+
+public:
+    cache_misses() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.exclude_kernel = 1;
+        fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~cache_misses() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    long read() const {
+        long count = 0;
+        if (fd < 0 || ::read(fd, &count, sizeof(count)) != sizeof(count)) {
+            return -1;
+        }
+        return count;
+    }
+};
+
+template<class P>
+static long first(const P &p) {
+    return p->v[0];
+}
+
+template<class P>
+static long first(const lib::optional<P> &o) {
+    return o.orElseThrow()->v[0];
+}
+
+static void printMisses(const cache_misses &counter, long before, long n) {
+    long after = counter.read();
+    if (before >= 0 && after >= 0) {
+        std::printf("%-48s %12s défauts de cache/elt : %.2f\n", "", "", (double) (after - before) / (double) n);
+    }
+}
+
+template<class Ptr, class Make>
+static long measure(const char *name, long n, Make make) {
+    std::vector<Ptr> src;
+    src.reserve(n);
+    for (long i = 0; i < n; i++) {
+        src.push_back(make(i));
+    }
+    std::shuffle(src.begin(), src.end(), std::mt19937(42));
+
+    char label[96];
+    long sum = 0;
+    cache_misses counter;
+    std::vector<Ptr> dst;
+    dst.reserve(n);
+    std::snprintf(label, sizeof(label), "%s copie", name);
+    long before = counter.read();
+    bench::runBatch(label, 1, n, [&]() {
+        for (long i = 0; i < n; i++) {
+            dst.push_back(src[i]);
+            sum += first(dst.back());
+        }
+    });
+    printMisses(counter, before, n);
+    std::snprintf(label, sizeof(label), "%s destruction", name);
+    before = counter.read();
+    bench::runBatch(label, 1, n, [&]() {
+        dst.clear();
+    });
+    printMisses(counter, before, n);
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 1L << 21);
+    check();
+    stress(n);
+    if (cache_misses().read() < 0) {
+        std::printf("compteurs matériels indisponibles : pas de mesure des défauts de cache\n");
+    }
+
+    typedef std::shared_ptr<PlainPayload> Shared;
+    typedef lib::intrusive_ptr<const AtomicPayload> Atomic;
+    long sums[] = {
+            measure<Shared>("shared_ptr(new T)", n, [](long i) { return Shared(new PlainPayload(i)); }),
+            measure<Shared>("make_shared", n, [](long i) { return std::make_shared<PlainPayload>(i); }),
+            measure<Atomic>("intrusive_ptr atomique", n, [](long i) {
+                return lib::make_intrusive<const AtomicPayload>(i);
+            }),
+            measure<lib::intrusive_ptr<Payload> >("intrusive_ptr non atomique", n, [](long i) {
+                return lib::make_intrusive<Payload>(i);
+            }),
+            measure<lib::optional<Shared> >("optional<shared_ptr>", n, [](long i) {
+                return lib::optional<Shared>::of(std::make_shared<PlainPayload>(i));
+            }),
+            measure<lib::optional<Atomic> >("optional<intrusive_ptr> atomique", n, [](long i) {
+                return lib::optional<Atomic>::of(lib::make_intrusive<const AtomicPayload>(i));
+            })
+    };
+    for (long sum : sums) {
+        if (sum != sums[0]) {
+            std::printf("résultats différents\n");
+            return 1;
+        }
+    }
+    return 0;
+}
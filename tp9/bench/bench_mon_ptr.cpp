@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "bench.hpp"
+#include "../Mon_ptr_u.hpp"
+
+/* std::vector<Mon_ptr_u<A>> : croissance (push_back sans reserve) puis tri par valeur,
+ * comparé à std::unique_ptr<A>.
+ *
+ * Le déplacement (noexcept) permet au vecteur de déplacer les pointeurs lors des
+ * réallocations et à std::sort de les permuter ; sans table virtuelle ni destructeur
+ * d'état, Mon_ptr_u<A> n'est qu'un pointeur, comme std::unique_ptr<A>.
+ */
+
+struct A {
+    int v;
+};
+
+static_assert(sizeof(Mon_ptr_u<A>) == sizeof(A *), "EBO du destructeur par défaut");
+static_assert(!std::is_polymorphic<Mon_ptr_u<A> >::value, "pas de table virtuelle");
+static_assert(std::is_nothrow_move_constructible<Mon_ptr_u<A> >::value, "déplacement noexcept");
+static_assert(std::is_nothrow_move_assignable<Mon_ptr_u<A> >::value, "affectation par déplacement noexcept");
+static_assert(!std::is_copy_constructible<Mon_ptr_u<A> >::value, "pas de copie");
+
+// Destructeur sans état : EBO, et avec état : un pointeur de fonction
+struct CountingDelete {
+    void operator()(A *a) const;
+};
+
+static long deleted = 0;
+
+void CountingDelete::operator()(A *a) const {
+    deleted++;
+    delete a;
+}
+
+static void deleteA(A *a) {
+    deleted++;
+    delete a;
+}
+
+static_assert(sizeof(Mon_ptr_u<A, CountingDelete>) == sizeof(A *), "EBO d'un foncteur sans état");
+static_assert(sizeof(Mon_ptr_u<A, void (*)(A *)>) == 2 * sizeof(A *), "pointeur de fonction conservé");
+static_assert(!std::is_constructible<Mon_ptr_u<A, void (*)(A *)>, A *>::value, "pointeur de fonction à passer");
+static_assert(std::is_constructible<Mon_ptr_u<A, CountingDelete>, A *>::value, "foncteur construit par défaut");
+
+static Mon_ptr_u<A> make(int v) {
+    // Retour depuis une fabrique : construction par déplacement
+    return Mon_ptr_u<A>(new A{v});
+}
+
+static void check() {
+    {
+        Mon_ptr_u<A, CountingDelete> a(new A{1});
+        Mon_ptr_u<A, void (*)(A *)> b(new A{2}, deleteA);
+        Mon_ptr_u<A, void (*)(A *)> c(std::move(b));
+        Mon_ptr_u<A, void (*)(A *)> d(new A{3}, deleteA);
+        d = std::move(c); // détruit A{3}
+        if (b || c || d->v != 2 || deleted != 1) {
+            std::printf("déplacement incorrect\n");
+            std::exit(1);
+        }
+    }
+    if (deleted != 3) {
+        std::printf("destructeurs incorrects\n");
+        std::exit(1);
+    }
+}
+
+template<class Ptr, class Make>
+static void growthAndSort(const char *name, long n, Make make) {
+    char label[96];
+    long passes = 20;
+    std::snprintf(label, sizeof(label), "%s croissance", name);
+    std::vector<Ptr> v;
+    bench::runBatch(label, passes, n, [&]() {
+        v = std::vector<Ptr>();
+        for (long i = 0; i < n; i++) {
+            v.push_back(make((int) ((i * 7919) % n)));
+        }
+    });
+    std::snprintf(label, sizeof(label), "%s tri", name);
+    bench::runBatch(label, 1, n, [&]() {
+        std::sort(v.begin(), v.end(), [](const Ptr &a, const Ptr &b) { return a->v < b->v; });
+    });
+    for (long i = 1; i < n; i++) {
+        if (v[i - 1]->v > v[i]->v) {
+            std::printf("%s : tri incorrect\n", name);
+            std::exit(1);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 1000000);
+    check();
+
+    // Préchauffage de l'allocateur : la première mesure ne paie pas seule les défauts de page
+    std::vector<std::unique_ptr<A> > warmup;
+    for (long i = 0; i < n; i++) {
+        warmup.push_back(std::unique_ptr<A>(new A{(int) i}));
+    }
+    warmup.clear();
+
+    growthAndSort<std::unique_ptr<A> >("std::unique_ptr<A>", n, [](int v) { return std::unique_ptr<A>(new A{v}); });
+    growthAndSort<Mon_ptr_u<A> >("Mon_ptr_u<A>", n, [](int v) { return make(v); });
+    return 0;
+}
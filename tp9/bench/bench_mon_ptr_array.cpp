@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include "bench.hpp"
+#include "../Mon_ptr_u.hpp"
+
+/* Allocation de tampons d'octets de 1 Mo à 1 Go par make_mon_ptr<unsigned char[]> :
+ *
+ * - valeur : make_mon_ptr<T[]>(n), new T[n]() met le tampon à zéro
+ * - défaut : make_mon_ptr<T[]>(n, Mon_default_init), new T[n] ne touche pas la mémoire
+ *
+ * Puis allocation suivie d'une écriture complète du tampon (cas d'un tampon de lecture) :
+ * la mise à zéro est alors une passe de plus sur la mémoire.
+ * Les grands tampons sont obtenus par mmap : une allocation non écrite ne coûte presque rien,
+ * la mise à zéro paie les défauts de page en plus de l'écriture. Les petits (1 à 16 Mo) sont
+ * réutilisés d'une passe à l'autre par malloc (seuil mmap dynamique de la glibc).
+ * GCC génère pour new unsigned char[n]() une boucle octet par octet et non un memset :
+ * c'est bien le coût payé par make_mon_ptr<T[]>(n).
+ */
+
+struct Counted {
+    static long alive;
+    int v;
+
+    Counted() : v{0} {
+        alive++;
+    }
+
+    explicit Counted(int v) : v{v} {
+        alive++;
+    }
+
+    ~Counted() {
+        alive--;
+    }
+};
+
+long Counted::alive = 0;
+
+static_assert(sizeof(Mon_ptr_u<int[]>) == sizeof(int *), "EBO de Mon_delete<int[]>");
+static_assert(std::is_nothrow_move_constructible<Mon_ptr_u<int[]> >::value, "déplacement noexcept");
+static_assert(!std::is_copy_constructible<Mon_ptr_u<int[]> >::value, "pas de copie");
+static_assert(!std::is_constructible<Mon_ptr_u<int[], void (*)(int *)>, int *>::value, "pointeur de fonction à passer");
+static_assert(std::is_same<decltype(make_mon_ptr<int[]>(4)), Mon_ptr_u<int[]> >::value, "fabrique de tableau");
+
+static void check() {
+    {
+        Mon_ptr_u<Counted> one = make_mon_ptr<Counted>(7);
+        Mon_ptr_u<Counted[]> many = make_mon_ptr<Counted[]>(16);
+        Mon_ptr_u<Counted[]> other = make_mon_ptr<Counted[]>(4, Mon_default_init);
+        many[3].v = one->v;
+        other = std::move(many); // delete[] des 4 éléments d'origine
+        if (many || other[3].v != 7 || Counted::alive != 17) {
+            std::printf("Mon_ptr_u<T[]> incorrect\n");
+            std::exit(1);
+        }
+        Mon_ptr_u<int[]> zeros = make_mon_ptr<int[]>(1024);
+        for (int i = 0; i < 1024; i++) {
+            if (zeros[i] != 0) {
+                std::printf("initialisation par valeur incorrecte\n");
+                std::exit(1);
+            }
+        }
+    }
+    if (Counted::alive != 0) {
+        std::printf("delete[] incorrect\n");
+        std::exit(1);
+    }
+}
+
+typedef Mon_ptr_u<unsigned char[]> Buffer;
+
+// passes allocations de size octets ; write : écriture complète de chaque tampon
+template<class Make>
+static void allocate(const char *name, std::size_t size, long passes, bool write, Make make) {
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s %5zu Mo%s", name, size >> 20, write ? " + écriture" : "");
+    bench::runBatch(label, passes, (long) size, [&]() {
+        Buffer b = make(size);
+        if (write) {
+            std::memset(b.get(), 0x5a, size);
+        }
+        bench::doNotOptimize(b.get());
+    });
+}
+
+int main(int argc, char **argv) {
+    // Octets alloués par mesure (2 Go par défaut), répartis en passes
+    long total = bench::iterations(argc, argv, 2L << 30);
+    check();
+
+    const std::size_t sizes[] = {1UL << 20, 16UL << 20, 256UL << 20, 1UL << 30};
+    for (std::size_t size : sizes) {
+        long passes = total / (long) size > 2 ? total / (long) size : 2;
+        for (bool write : {false, true}) {
+            allocate("valeur", size, passes, write, [](std::size_t n) {
+                return make_mon_ptr<unsigned char[]>(n);
+            });
+            allocate("défaut", size, passes, write, [](std::size_t n) {
+                return make_mon_ptr<unsigned char[]>(n, Mon_default_init);
+            });
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+#include "bench.hpp"
+#include "../optional.hpp"
+
+/* map et filter de lib::optional sur des optionnels majoritairement vides
+ * (9 sur 10), pour chacune des surcharges : pointeur de fonction, std::function
+ * et appelable générique.
+ *
+ * Avant / après : les versions d'origine de map et filter (try/catch autour
+ * d'orElseThrow pour savoir si l'optional est vide) sont conservées ci-dessous,
+ * dans l'espace de noms reference, et mesurées avec les mêmes arguments.
+ *
+ * Vérifie aussi que filter et map acceptent un type sans constructeur par défaut
+ * et que les copies d'un optional sont indépendantes.
+ */
+
+struct C {
+    int x;
+};
+
+static bool pred(C c) {
+    return c.x % 3 == 0;
+}
+
+static int *twice(C c) {
+    return new int{2 * c.x};
+}
+
+// Pas de constructeur par défaut
+struct NoDefault {
+    int v;
+
+    explicit NoDefault(int v) : v{v} {}
+};
+
+static bool positive(NoDefault d) {
+    return d.v > 0;
+}
+
+namespace reference {
+
+    // filter d'origine : T tval exige un constructeur par défaut, un optional vide lève une exception
+    template<class T, class P>
+    lib::optional<T> filter(const lib::optional<T> &o, P predicate) {
+        T tval;
+        try {
+            tval = o.orElseThrow();
+        } catch (std::runtime_error &error) {
+            return lib::optional<T>::empty();
+        }
+        if (predicate(tval)) {
+            return o;
+        }
+        return lib::optional<T>::empty();
+    }
+
+    /* map d'origine : ofNullable copie *u. L'original perdait u ; on le libère ici
+     * pour que le benchmark reste sans fuite (un delete de plus que l'original).
+     */
+    template<class U, class T, class F>
+    lib::optional<U> map(const lib::optional<T> &o, F f) {
+        if (o.isEmpty()) { return lib::optional<U>::empty(); }
+        U *u;
+        try {
+            u = f(o.orElseThrow());
+        } catch (std::runtime_error &error) {
+            return lib::optional<U>::empty();
+        }
+        lib::optional<U> result = lib::optional<U>::ofNullable(u);
+        delete u;
+        return result;
+    }
+
+}
+
+static void check() {
+    NoDefault d{1};
+    lib::optional<NoDefault> o = lib::optional<NoDefault>::of(d);
+    lib::optional<NoDefault> copy = o;
+    lib::optional<NoDefault> assigned = lib::optional<NoDefault>::empty();
+    assigned = copy;
+    std::function<bool(NoDefault)> positiveFunction = positive;
+    bool ok = o.filter(positive).isPresent()
+              && o.filter(positiveFunction).isPresent()
+              && lib::optional<NoDefault>::empty().filter(positive).isEmpty()
+              && o.map([](const NoDefault &n) { return new int{n.v + 1}; }).orElseThrow() == 2
+              && assigned.orElseThrow().v == 1
+              && static_cast<bool>(o) && !lib::optional<NoDefault>::empty();
+    if (!ok) {
+        std::printf("optional incorrect\n");
+        std::exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    check();
+
+    long n = bench::iterations(argc, argv, 2000000);
+
+    std::vector<lib::optional<C> > values;
+    for (int i = 0; i < 1000; i++) {
+        C c{i};
+        values.push_back(i % 10 == 0 ? lib::optional<C>::of(c) : lib::optional<C>::empty());
+    }
+    std::function<bool(C)> predFunction = pred;
+    std::function<int *(C)> twiceFunction = twice;
+
+    // Nombre d'optionals présents après chaque opération, avant et après réécriture
+    long present = 0;
+    long before = 0;
+    long after = 0;
+    bench::run("filter(pointeur de fonction), try/catch (avant)", n, [&](long i) {
+        before += reference::filter(values[i % values.size()], pred).isPresent();
+    });
+    bench::run("filter(pointeur de fonction)", n, [&](long i) {
+        after += values[i % values.size()].filter(pred).isPresent();
+    });
+    bench::run("filter(std::function), try/catch (avant)", n, [&](long i) {
+        before += reference::filter(values[i % values.size()], predFunction).isPresent();
+    });
+    bench::run("filter(std::function)", n, [&](long i) {
+        after += values[i % values.size()].filter(predFunction).isPresent();
+    });
+    bench::run("filter(lambda)", n, [&](long i) {
+        present += values[i % values.size()].filter([](const C &c) { return c.x % 3 == 0; }).isPresent();
+    });
+    bench::run("map(pointeur de fonction), copie (avant)", n, [&](long i) {
+        before += reference::map<int>(values[i % values.size()], twice).isPresent();
+    });
+    bench::run("map(pointeur de fonction)", n, [&](long i) {
+        after += values[i % values.size()].map(twice).isPresent();
+    });
+    bench::run("map(std::function), copie (avant)", n, [&](long i) {
+        before += reference::map<int>(values[i % values.size()], twiceFunction).isPresent();
+    });
+    bench::run("map(std::function)", n, [&](long i) {
+        after += values[i % values.size()].map(twiceFunction).isPresent();
+    });
+    if (before != after) {
+        std::printf("résultats différents avant / après\n");
+        return 1;
+    }
+    bench::doNotOptimize(present);
+    bench::doNotOptimize(after);
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include "bench.hpp"
+#include "../Mon_ptr_u.hpp"
+#include "../tagged_ptr.hpp"
+
+/* Liste chaînée de n noeuds portant deux drapeaux (marqué, visité) :
+ *
+ * - PlainNode : Mon_ptr_u<PlainNode> next et deux bool, 8 octets de remplissage
+ * - TaggedNode : tagged_ptr<TaggedNode, 2> next, les drapeaux dans les bits bas du pointeur
+ *
+ * Mesures par noeud : construction (allocation), marquage (écriture des drapeaux),
+ * parcours (lecture des drapeaux et de la valeur), destruction.
+ * malloc arrondit les blocs à 16 octets plus un en-tête : un noeud de 32 octets occupe
+ * un bloc de 48 octets, un noeud de 24 octets un bloc de 32.
+ */
+
+struct PlainNode {
+    long key;
+    long value;
+    Mon_ptr_u<PlainNode> next;
+    bool marked;
+    bool visited;
+
+    PlainNode(long key, Mon_ptr_u<PlainNode> &&next) : key{key}, value{key * 3}, next{std::move(next)},
+                                                      marked{false}, visited{false} {}
+};
+
+struct TaggedNode {
+    long key;
+    long value;
+    tagged_ptr<TaggedNode, 2> next; // bit 0 : marqué, bit 1 : visité
+
+    TaggedNode(long key, tagged_ptr<TaggedNode, 2> &&next) : key{key}, value{key * 3}, next{std::move(next)} {}
+};
+
+static_assert(sizeof(PlainNode) == 4 * sizeof(long), "pointeur, deux bool et remplissage");
+static_assert(sizeof(TaggedNode) == 3 * sizeof(long), "drapeaux dans le pointeur");
+static_assert(sizeof(tagged_ptr<long>) == sizeof(long *), "EBO du destructeur par défaut");
+static_assert(std::is_nothrow_move_constructible<tagged_ptr<long> >::value, "déplacement noexcept");
+
+// Types refusés : pas assez de bits libres dans l'alignement
+struct Packed {
+    char c[3];
+};
+
+static_assert(tagged_bits<char>::value == 0 && tagged_bits<short>::value == 1, "log2(alignof)");
+static_assert(tagged_bits<long>::value == 3 && tagged_bits<TaggedNode>::value == 3, "log2(alignof)");
+static_assert(!tagged_fits<char, 1>::value, "char n'a aucun bit libre");
+static_assert(!tagged_fits<Packed, 1>::value, "Packed n'a aucun bit libre");
+static_assert(!tagged_fits<int, 3>::value, "int n'a que 2 bits libres");
+static_assert(!tagged_fits<long, 0>::value, "au moins un bit");
+static_assert(tagged_fits<int, 2>::value && tagged_fits<TaggedNode, 2>::value, "bits disponibles");
+// Instancier tagged_ptr avec ces types ne compile pas : cf. test/tagged_ptr_misaligned.cpp
+
+static long deleted = 0;
+
+struct CountingDelete {
+    void operator()(long *l) const {
+        deleted++;
+        delete l;
+    }
+};
+
+static void fail(const char *what) {
+    std::printf("tagged_ptr : %s incorrect\n", what);
+    std::exit(1);
+}
+
+static void check() {
+    {
+        typedef tagged_ptr<long, 3, CountingDelete> Ptr;
+        long *raw = new long{5};
+        Ptr a(raw, 5);
+        if (a.get() != raw || a.tag() != 5 || *a != 5 || !a) {
+            fail("constructeur");
+        }
+        a.set_tag(2);
+        *a = 6;
+        if (a.tag() != 2 || *a.operator->() != 6 || a.get() != raw) {
+            fail("set_tag");
+        }
+        a.set_tag(9); // 9 & 7
+        if (a.tag() != 1) {
+            fail("masque de set_tag");
+        }
+        Ptr b(new long{7}, 6);
+        a.echange(b);
+        if (*a != 7 || a.tag() != 6 || *b != 6 || b.tag() != 1) {
+            fail("echange");
+        }
+        Ptr c(std::move(a));
+        if (a || a.tag() != 0 || *c != 7 || c.tag() != 6) {
+            fail("déplacement");
+        }
+        b = std::move(c); // détruit 6
+        if (deleted != 1 || *b != 7 || b.tag() != 6 || c.tag() != 0) {
+            fail("affectation par déplacement");
+        }
+        Ptr d(nullptr, 3);
+        if (d || d.tag() != 3) {
+            fail("pointeur nul étiqueté");
+        }
+        long *r = b.release();
+        if (b || b.tag() != 6 || *r != 7) {
+            fail("release");
+        }
+        delete r;
+    }
+    if (deleted != 1) {
+        fail("destructeur");
+    }
+}
+
+// Accès aux drapeaux
+static bool isMarked(const PlainNode &n) {
+    return n.marked;
+}
+
+static void mark(PlainNode &n, bool marked) {
+    n.marked = marked;
+    n.visited = true;
+}
+
+static bool isMarked(const TaggedNode &n) {
+    return (n.next.tag() & 1) != 0;
+}
+
+static void mark(TaggedNode &n, bool marked) {
+    n.next.set_tag((marked ? 1 : 0) | 2);
+}
+
+static PlainNode *nextOf(const PlainNode &n) {
+    return n.next.get();
+}
+
+static TaggedNode *nextOf(const TaggedNode &n) {
+    return n.next.get();
+}
+
+template<class Node, class Ptr>
+static long measure(const char *name, long n, long passes) {
+    char label[96];
+    long total = 0;
+    for (long p = 0; p < passes; p++) {
+        Ptr head(nullptr);
+        std::snprintf(label, sizeof(label), "%s (%zu o) construction", name, sizeof(Node));
+        bench::runBatch(label, 1, n, [&]() {
+            for (long i = 0; i < n; i++) {
+                head = Ptr(new Node(i, std::move(head)));
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s (%zu o) marquage", name, sizeof(Node));
+        bench::runBatch(label, 1, n, [&]() {
+            // Le suivant est lu avant l'écriture des drapeaux : pour TaggedNode, le relire juste
+            // après set_tag ajouterait la réexpédition de l'écriture au chaînage des lectures
+            for (Node *node = head.get(); node != nullptr;) {
+                Node *next = nextOf(*node);
+                mark(*node, node->key % 3 == 0);
+                node = next;
+            }
+        });
+        long sum = 0;
+        std::snprintf(label, sizeof(label), "%s (%zu o) parcours", name, sizeof(Node));
+        bench::runBatch(label, 1, n, [&]() {
+            for (Node *node = head.get(); node != nullptr; node = nextOf(*node)) {
+                if (isMarked(*node)) {
+                    sum += node->value;
+                }
+            }
+        });
+        // Destruction itérative : le destructeur récursif d'un long chaînage déborderait la pile
+        std::snprintf(label, sizeof(label), "%s (%zu o) destruction", name, sizeof(Node));
+        bench::runBatch(label, 1, n, [&]() {
+            while (head) {
+                Ptr next(std::move(head->next));
+                head = std::move(next);
+            }
+        });
+        total += sum;
+    }
+    return total;
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 1000000);
+    check();
+
+    long plain = measure<PlainNode, Mon_ptr_u<PlainNode> >("Mon_ptr_u + 2 bool", n, 3);
+    long tagged = measure<TaggedNode, tagged_ptr<TaggedNode, 2> >("tagged_ptr<Node, 2>", n, 3);
+    if (plain != tagged) {
+        std::printf("résultats différents\n");
+        return 1;
+    }
+    return 0;
+}
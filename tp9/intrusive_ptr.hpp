@@ -0,0 +1,398 @@
+#ifndef TP9_INTRUSIVE_PTR_HPP
+#define TP9_INTRUSIVE_PTR_HPP
+
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "optional.hpp"
+
+/* lib::intrusive_ptr<T> : possession partagée, le compteur de références dans l'objet.
+ *
+ * Mon_ptr_u possède seul son objet ; intrusive_ptr le partage. Contrairement à
+ * std::shared_ptr, il n'y a pas de bloc de contrôle séparé : T hérite de ref_counted<T>
+ * (un seul thread) ou de atomic_ref_counted<T> (copies et destructions depuis plusieurs
+ * threads), l'objet et son compteur sont alloués ensemble et sur la même ligne de cache.
+ * intrusive_ptr n'est qu'un pointeur : sizeof(intrusive_ptr<T>) == sizeof(T *).
+ *
+ *   class Payload : public lib::atomic_ref_counted<Payload> { ... };
+ *   lib::intrusive_ptr<const Payload> p = lib::make_intrusive<const Payload>(...);
+ *
+ * Le compteur est mutable : un intrusive_ptr<const T> partage un objet immuable.
+ * Le dernier intrusive_ptr détruit l'objet par delete, en tant que T (pas de destructeur
+ * virtuel nécessaire).
+ */
+
+namespace lib {
+
+    template<class T>
+    class intrusive_ptr;
+
+    // Compteur non atomique : les intrusive_ptr d'un même objet restent dans un seul thread
+    template<class Derived>
+    class ref_counted {
+    private:
+        mutable long refs;
+
+    protected:
+        ref_counted();
+
+        // Une copie de l'objet est un nouvel objet : son compteur repart de 0
+        ref_counted(const ref_counted<Derived> &);
+
+        ref_counted<Derived> &operator=(const ref_counted<Derived> &);
+
+        ~ref_counted() = default;
+
+    public:
+        static void intrusive_add_ref(const Derived *d);
+
+        // Détruit d si c'était la dernière référence
+        static void intrusive_release(const Derived *d);
+
+        long use_count() const;
+    };
+
+    /* Compteur atomique : incrément relâché, décrément release puis barrière acquire
+     * avant la destruction, pour que le thread qui détruit voie toutes les écritures
+     * faites sur l'objet par les autres
+     */
+    template<class Derived>
+    class atomic_ref_counted {
+    private:
+        mutable std::atomic<long> refs;
+
+    protected:
+        atomic_ref_counted();
+
+        atomic_ref_counted(const atomic_ref_counted<Derived> &);
+
+        atomic_ref_counted<Derived> &operator=(const atomic_ref_counted<Derived> &);
+
+        ~atomic_ref_counted() = default;
+
+    public:
+        static void intrusive_add_ref(const Derived *d);
+
+        static void intrusive_release(const Derived *d);
+
+        long use_count() const;
+    };
+
+    template<class T>
+    class intrusive_ptr {
+    private:
+        template<class U>
+        friend class intrusive_ptr;
+
+        // La classe qui porte intrusive_add_ref et intrusive_release (T sans const)
+        typedef typename std::remove_cv<T>::type counted;
+
+        T *t;
+
+    public:
+        // Pointeur nul
+        intrusive_ptr();
+
+        // Ajoute une référence à t : juste après new (compteur à 0), intrusive_ptr en devient l'unique propriétaire
+        explicit intrusive_ptr(T *t);
+
+        intrusive_ptr(const intrusive_ptr<T> &p);
+
+        intrusive_ptr(intrusive_ptr<T> &&p) noexcept;
+
+        // ex : intrusive_ptr<Payload> vers intrusive_ptr<const Payload>
+        template<class U, class = typename std::enable_if<std::is_convertible<U *, T *>::value>::type>
+        intrusive_ptr(const intrusive_ptr<U> &p);
+
+        // Non virtuel : intrusive_ptr n'est qu'un pointeur
+        ~intrusive_ptr();
+
+        intrusive_ptr<T> &operator=(const intrusive_ptr<T> &p);
+
+        intrusive_ptr<T> &operator=(intrusive_ptr<T> &&p) noexcept;
+
+        void echange(intrusive_ptr<T> &p);
+
+        T *get() const;
+
+        T &operator*() const;
+
+        T *operator->() const;
+
+        explicit operator bool() const;
+
+        // Nombre d'intrusive_ptr qui partagent l'objet, 0 si nul
+        long use_count() const;
+    };
+
+    // Une seule allocation : l'objet et son compteur
+    template<class T, class... Args>
+    intrusive_ptr<T> make_intrusive(Args &&... args);
+
+    /* optional<intrusive_ptr<T>> : un optionnel de valeur partagée n'est que le pointeur,
+     * vide s'il est nul. Sa copie ajoute une référence, sans allouer ni copier la valeur
+     * (optional<T> alloue et copie un T, optional<std::shared_ptr<T> > alloue un shared_ptr).
+     * Pas de destructeur virtuel : sizeof(optional<intrusive_ptr<T> >) == sizeof(T *).
+     * of(p) avec p nul retourne un optionnel vide.
+     */
+    template<class T>
+    class optional<intrusive_ptr<T> > {
+    private:
+        template<class U>
+        friend class optional;
+
+        intrusive_ptr<T> p;
+
+        explicit optional(const intrusive_ptr<T> &p);
+
+    public:
+        explicit operator bool() const;
+
+        static optional<intrusive_ptr<T> > of(const intrusive_ptr<T> &p);
+
+        static optional<intrusive_ptr<T> > ofNullable(intrusive_ptr<T> *p);
+
+        static const optional<intrusive_ptr<T> > &empty();
+
+        bool isEmpty() const;
+
+        bool isPresent() const;
+
+        intrusive_ptr<T> orElseThrow() const;
+
+        intrusive_ptr<T> orElse(const intrusive_ptr<T> &other) const;
+
+        // Comme optional<T>::map : f retourne un pointeur alloué par new, dont l'optional<U> prend possession
+        template<class F>
+        optional<typename std::remove_pointer<typename std::result_of<F(const intrusive_ptr<T> &)>::type>::type>
+        map(F &&f) const;
+
+        // Retourne une copie de l'optionnel (une référence de plus) ou l'optionnel vide
+        template<class F>
+        optional<intrusive_ptr<T> > filter(F &&predicate) const;
+    };
+
+    // ========== ref_counted ==========
+
+    template<class Derived>
+    ref_counted<Derived>::ref_counted() : refs{0} {}
+
+    template<class Derived>
+    ref_counted<Derived>::ref_counted(const ref_counted<Derived> &) : refs{0} {}
+
+    template<class Derived>
+    ref_counted<Derived> &ref_counted<Derived>::operator=(const ref_counted<Derived> &) {
+        return *this;
+    }
+
+    template<class Derived>
+    void ref_counted<Derived>::intrusive_add_ref(const Derived *d) {
+        static_cast<const ref_counted<Derived> *>(d)->refs++;
+    }
+
+    template<class Derived>
+    void ref_counted<Derived>::intrusive_release(const Derived *d) {
+        if (--static_cast<const ref_counted<Derived> *>(d)->refs == 0) {
+            delete d;
+        }
+    }
+
+    template<class Derived>
+    long ref_counted<Derived>::use_count() const {
+        return refs;
+    }
+
+    // ========== atomic_ref_counted ==========
+
+    template<class Derived>
+    atomic_ref_counted<Derived>::atomic_ref_counted() : refs{0} {}
+
+    template<class Derived>
+    atomic_ref_counted<Derived>::atomic_ref_counted(const atomic_ref_counted<Derived> &) : refs{0} {}
+
+    template<class Derived>
+    atomic_ref_counted<Derived> &atomic_ref_counted<Derived>::operator=(const atomic_ref_counted<Derived> &) {
+        return *this;
+    }
+
+    template<class Derived>
+    void atomic_ref_counted<Derived>::intrusive_add_ref(const Derived *d) {
+        static_cast<const atomic_ref_counted<Derived> *>(d)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template<class Derived>
+    void atomic_ref_counted<Derived>::intrusive_release(const Derived *d) {
+        if (static_cast<const atomic_ref_counted<Derived> *>(d)->refs.fetch_sub(1, std::memory_order_release) == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            delete d;
+        }
+    }
+
+    template<class Derived>
+    long atomic_ref_counted<Derived>::use_count() const {
+        return refs.load(std::memory_order_relaxed);
+    }
+
+    // ========== intrusive_ptr ==========
+
+    template<class T>
+    intrusive_ptr<T>::intrusive_ptr() : t{nullptr} {}
+
+    template<class T>
+    intrusive_ptr<T>::intrusive_ptr(T *t) : t{t} {
+        if (t != nullptr) {
+            counted::intrusive_add_ref(t);
+        }
+    }
+
+    template<class T>
+    intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr<T> &p) : intrusive_ptr(p.t) {}
+
+    template<class T>
+    intrusive_ptr<T>::intrusive_ptr(intrusive_ptr<T> &&p) noexcept : t{p.t} {
+        p.t = nullptr;
+    }
+
+    template<class T>
+    template<class U, class>
+    intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr<U> &p) : intrusive_ptr(p.t) {}
+
+    template<class T>
+    intrusive_ptr<T>::~intrusive_ptr() {
+        if (t != nullptr) {
+            counted::intrusive_release(t);
+        }
+    }
+
+    template<class T>
+    intrusive_ptr<T> &intrusive_ptr<T>::operator=(const intrusive_ptr<T> &p) {
+        // Référence ajoutée avant d'enlever l'ancienne : p peut être *this
+        intrusive_ptr<T> copy(p);
+        echange(copy);
+        return *this;
+    }
+
+    template<class T>
+    intrusive_ptr<T> &intrusive_ptr<T>::operator=(intrusive_ptr<T> &&p) noexcept {
+        if (this != &p) {
+            intrusive_ptr<T> old(std::move(*this));
+            echange(p);
+        }
+        return *this;
+    }
+
+    template<class T>
+    void intrusive_ptr<T>::echange(intrusive_ptr<T> &p) {
+        T *other = p.t;
+        p.t = t;
+        t = other;
+    }
+
+    template<class T>
+    T *intrusive_ptr<T>::get() const {
+        return t;
+    }
+
+    template<class T>
+    T &intrusive_ptr<T>::operator*() const {
+        return *t;
+    }
+
+    template<class T>
+    T *intrusive_ptr<T>::operator->() const {
+        return t;
+    }
+
+    template<class T>
+    intrusive_ptr<T>::operator bool() const {
+        return t != nullptr;
+    }
+
+    template<class T>
+    long intrusive_ptr<T>::use_count() const {
+        return t == nullptr ? 0 : t->use_count();
+    }
+
+    template<class T, class... Args>
+    intrusive_ptr<T> make_intrusive(Args &&... args) {
+        return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+    }
+
+    // ========== optional<intrusive_ptr<T>> ==========
+
+    template<class T>
+    optional<intrusive_ptr<T> >::optional(const intrusive_ptr<T> &p) : p{p} {}
+
+    template<class T>
+    optional<intrusive_ptr<T> >::operator bool() const {
+        return isPresent();
+    }
+
+    template<class T>
+    optional<intrusive_ptr<T> > optional<intrusive_ptr<T> >::of(const intrusive_ptr<T> &p) {
+        return optional<intrusive_ptr<T> >(p);
+    }
+
+    template<class T>
+    optional<intrusive_ptr<T> > optional<intrusive_ptr<T> >::ofNullable(intrusive_ptr<T> *p) {
+        if (p == nullptr) return empty();
+        return of(*p);
+    }
+
+    template<class T>
+    const optional<intrusive_ptr<T> > &optional<intrusive_ptr<T> >::empty() {
+        static const optional<intrusive_ptr<T> > none{intrusive_ptr<T>()};
+        return none;
+    }
+
+    template<class T>
+    bool optional<intrusive_ptr<T> >::isEmpty() const {
+        return !p;
+    }
+
+    template<class T>
+    bool optional<intrusive_ptr<T> >::isPresent() const {
+        return !isEmpty();
+    }
+
+    template<class T>
+    intrusive_ptr<T> optional<intrusive_ptr<T> >::orElseThrow() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Tried getting value from None type");
+        }
+        return p;
+    }
+
+    template<class T>
+    intrusive_ptr<T> optional<intrusive_ptr<T> >::orElse(const intrusive_ptr<T> &other) const {
+        if (isEmpty()) {
+            return other;
+        }
+        return p;
+    }
+
+    template<class T>
+    template<class F>
+    optional<typename std::remove_pointer<typename std::result_of<F(const intrusive_ptr<T> &)>::type>::type>
+    optional<intrusive_ptr<T> >::map(F &&f) const {
+        typedef typename std::result_of<F(const intrusive_ptr<T> &)>::type pointer;
+        static_assert(std::is_pointer<pointer>::value, "map attend une fonction retournant un pointeur");
+        typedef typename std::remove_pointer<pointer>::type U;
+        if (isEmpty()) { return optional<U>::empty(); }
+        return optional<U>(std::forward<F>(f)(p));
+    }
+
+    template<class T>
+    template<class F>
+    optional<intrusive_ptr<T> > optional<intrusive_ptr<T> >::filter(F &&predicate) const {
+        if (isEmpty() || !std::forward<F>(predicate)(p)) {
+            return empty();
+        }
+        return *this;
+    }
+
+}
+
+
+#endif //TP9_INTRUSIVE_PTR_HPP
@@ -35,8 +35,7 @@ public:
     std::string s;
 };
 
-class H :
-        public std::unary_function<C, D *> {
+class H {
     D *operator()(C c) {
         if (c.x > 0) {
             return new D{"hello"};
@@ -142,5 +141,8 @@ int main() {
     lib::optional<C>::ofNullable(c).map(goodLambda);
     cout << lib::optional<C>::ofNullable(c).filter(goodLambda2).isEmpty() << endl;
     cout << lib::optional<C>::ofNullable(c).filter(pred).isEmpty() << endl;
+    // ofNullable copie la valeur pointée : x et c restent à libérer
+    delete x;
+    delete c;
     return 0;
 }
\ No newline at end of file
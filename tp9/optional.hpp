@@ -1,8 +1,10 @@
 #ifndef OPTIONAL_HPP
 #define OPTIONAL_HPP
 
+#include <functional>
 #include <ostream>
-#include <regex>
+#include <stdexcept>
+#include <type_traits>
 
 
 namespace lib {
@@ -10,15 +12,26 @@ namespace lib {
     template<class T>
     class optional {
     private:
+        template<class U>
+        friend class optional;
+
         T *t;
 
+        // Prend possession de t (alloué par new)
         explicit optional(T *t) : t{t} {}
 
         const static optional<T> &none;
     public:
+        // Libère la valeur
         virtual ~optional();
 
-        optional(const optional<T> &o) : t{o.t} {}
+        // La copie copie la valeur : chaque optional possède la sienne
+        optional(const optional<T> &o);
+
+        optional<T> &operator=(const optional<T> &o);
+
+        // Le déplacement transfère simplement le pointeur
+        optional(optional<T> &&o) noexcept;
 
         optional<T> &operator=(optional<T> &&o) noexcept;
 
@@ -26,6 +39,7 @@ namespace lib {
 
         static optional<T> of(const T &t);
 
+        // Copie *t (si t n'est pas nul) : t reste à la charge de l'appelant
         static optional<T> ofNullable(T *t);
 
         static const optional<T> &empty();
@@ -38,85 +52,111 @@ namespace lib {
 
         T orElse(T &other) const;
 
+        /* map et filter ne font qu'un test de vacuité : ni exception, ni copie
+         * intermédiaire de la valeur, et T n'a pas besoin d'être constructible par défaut.
+         *
+         * Attention : map prend possession du pointeur U* retourné par f, sans le copier.
+         * f doit retourner un objet alloué par new (ou nullptr, l'optional est alors vide)
+         * que rien d'autre ne possède : l'optional retourné le détruit avec delete.
+         * C'est l'inverse d'ofNullable, qui copie *t et laisse t à l'appelant.
+         */
         template<class U>
-        optional<U> map(std::function<U* (T)> f);
+        optional<U> map(std::function<U* (T)> f) const;
         template<class U>
-        optional<U> map(U* (*f)(T));
+        optional<U> map(U* (*f)(T)) const;
+
 
+        optional<T> filter(std::function<bool (T)> predicate) const;
+        optional<T> filter(bool (*predicate)(T)) const;
 
-        optional<T> filter(std::function<bool (T)> predicate);
-        optional<T> filter(bool (*predicate)(T));
+        // Versions génériques : n'importe quel appelable, sans passer par std::function
+        // map générique : même contrat de possession que ci-dessus
+        template<class F>
+        optional<typename std::remove_pointer<typename std::result_of<F(const T &)>::type>::type>
+        map(F &&f) const;
+
+        template<class F>
+        optional<T> filter(F &&predicate) const;
     };
 
     template<class T>
-    template<class U>
-    optional<U> optional<T>::map(std::function<U* (T)> f) {
+    template<class F>
+    optional<typename std::remove_pointer<typename std::result_of<F(const T &)>::type>::type>
+    optional<T>::map(F &&f) const {
+        typedef typename std::result_of<F(const T &)>::type pointer;
+        static_assert(std::is_pointer<pointer>::value, "map attend une fonction retournant un pointeur");
+        typedef typename std::remove_pointer<pointer>::type U;
         if (isEmpty()) { return optional<U>::empty(); }
-        U *u;
-        try {
-            u = f(this->orElseThrow());
-        } catch (std::runtime_error &error) {
-            return optional<U>::empty();
+        return optional<U>(std::forward<F>(f)(*t));
+    }
+
+    template<class T>
+    template<class F>
+    optional<T> optional<T>::filter(F &&predicate) const {
+        if (isEmpty() || !std::forward<F>(predicate)(*t)) {
+            return none;
         }
-        return optional<U>::ofNullable(u);
+        return *this;
     }
 
     template<class T>
     template<class U>
-    optional<U> optional<T>::map(U* (*f)(T)) {
+    optional<U> optional<T>::map(std::function<U* (T)> f) const {
         if (isEmpty()) { return optional<U>::empty(); }
-        U *u;
-        try {
-            u = (*f)(this->orElseThrow());
-        } catch (std::runtime_error &error) {
-            return optional<U>::empty();
-        }
-        return optional<U>::ofNullable(u);
+        return optional<U>(f(*t));
+    }
+
+    template<class T>
+    template<class U>
+    optional<U> optional<T>::map(U* (*f)(T)) const {
+        if (isEmpty()) { return optional<U>::empty(); }
+        return optional<U>((*f)(*t));
     }
 
     template<class T>
     optional<T>
-    optional<T>::filter(std::function<bool (T)> predicate) {
-        T tval;
-        try {
-            tval = this->orElseThrow();
-        } catch (std::runtime_error &error) {
-            return optional<T>::empty();
-        }
-        if (predicate(tval)) {
-            return *this;
+    optional<T>::filter(std::function<bool (T)> predicate) const {
+        if (isEmpty() || !predicate(*t)) {
+            return none;
         }
-        return none;
+        return *this;
     }
 
     template<class T>
     optional<T>
-    optional<T>::filter(bool(*predicate)(T)) {
-        T tval;
-        try {
-            tval = this->orElseThrow();
-        } catch (std::runtime_error &error) {
-            return optional<T>::empty();
-        }
-        if ((*predicate)(tval)) {
-            return *this;
+    optional<T>::filter(bool(*predicate)(T)) const {
+        if (isEmpty() || !(*predicate)(*t)) {
+            return none;
         }
-        return none;
+        return *this;
     }
 
     template<class T>
     optional<T>::operator bool() const {
-        return !empty();
+        return isPresent();
+    }
+
+    template<class T>
+    optional<T>::optional(const optional<T> &o) : t{o.t == nullptr ? nullptr : new T(*o.t)} {}
+
+    template<class T>
+    optional<T> &optional<T>::operator=(const optional<T> &o) {
+        if (this != &o) {
+            T *copy = o.t == nullptr ? nullptr : new T(*o.t);
+            delete this->t;
+            this->t = copy;
+        }
+        return *this;
+    }
+
+    template<class T>
+    optional<T>::optional(optional<T> &&o) noexcept : t{o.t} {
+        o.t = nullptr;
     }
 
     template<class T>
     optional<T> &optional<T>::operator=(optional<T> &&o) noexcept {
         if (this != &o) {
-            if (o.isEmpty()) {
-                delete this->t;
-                this->t = o.t;
-                return *this;
-            }
             delete this->t;
             this->t = o.t;
             o.t = nullptr;
@@ -147,7 +187,7 @@ namespace lib {
 
     template<class T>
     optional<T>::~optional() {
-        //if (t != nullptr) delete t;
+        delete t;
     }
 
     template<class T>
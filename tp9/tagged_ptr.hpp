@@ -0,0 +1,101 @@
+#ifndef TP9_TAGGED_PTR_HPP
+#define TP9_TAGGED_PTR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "Mon_ptr_u.hpp"
+
+/* tagged_ptr<T, Bits> : un Mon_ptr_u qui range Bits bits d'étiquette (des drapeaux)
+ * dans les bits de poids faible du pointeur.
+ *
+ * Un T * valide est un multiple de alignof(T) : ses log2(alignof(T)) bits de poids faible
+ * sont toujours nuls. Un noeud { Mon_ptr_u<Node> next; bool a; bool b; } paie 8 octets de
+ * remplissage pour ses deux booléens ; avec tagged_ptr<Node, 2>, il n'a plus que le pointeur.
+ *
+ * Le pointeur et l'étiquette sont indépendants : release, echange et le déplacement
+ * agissent sur le pointeur, l'étiquette reste attachée à l'emplacement (release) ou suit
+ * le pointeur (echange, déplacement).
+ *
+ * Bits doit être compris entre 1 et log2(alignof(T)) (cf. tagged_fits) : un type aligné
+ * sur 1 octet (char, struct de char) n'a pas de bit libre et est refusé à la compilation.
+ * Pour un type incomplet (noeud qui se référence lui-même), Bits doit être donné
+ * explicitement. La classe vérifie dès son instanciation ce qui ne dépend pas de T
+ * (1 <= Bits <= log2(alignof(std::max_align_t))) ; alignof(T) n'est vérifié qu'une fois
+ * T complet, par les constructeurs qui prennent un T * (cf. word).
+ */
+
+constexpr unsigned tagged_log2(std::size_t n) {
+    return n < 2 ? 0 : 1 + tagged_log2(n / 2);
+}
+
+// Nombre de bits de poids faible toujours nuls dans un T * : log2(alignof(T))
+template<class T>
+struct tagged_bits : std::integral_constant<unsigned, tagged_log2(alignof(T))> {
+};
+
+// Vrai si Bits bits d'étiquette tiennent dans l'alignement de T
+template<class T, unsigned Bits>
+struct tagged_fits : std::integral_constant<bool, Bits >= 1 && Bits <= tagged_bits<T>::value> {
+};
+
+template<class T, unsigned Bits = tagged_bits<T>::value, class Deleter = Mon_delete<T> >
+class tagged_ptr {
+private:
+    static_assert(Bits >= 1 && Bits <= tagged_log2(alignof(std::max_align_t)),
+                  "Bits doit être compris entre 1 et log2(alignof(T))");
+
+    // Le pointeur et l'étiquette dans un même mot
+    Mon_ptr_holder<std::uintptr_t, Deleter> h;
+
+    static constexpr std::uintptr_t tag_mask = (std::uintptr_t(1) << Bits) - 1;
+
+    // Appelé par tous les constructeurs qui prennent un T * : vérifie tagged_fits<T, Bits>
+    static std::uintptr_t word(T *ptr, unsigned tag);
+
+    // Détruit l'objet possédé par Deleter puis possède ptr, sans changer l'étiquette
+    void reset(T *ptr);
+
+public:
+    explicit tagged_ptr(T *ptr, unsigned tag = 0);
+
+    tagged_ptr(T *ptr, unsigned tag, const Deleter &d);
+
+    tagged_ptr(tagged_ptr<T, Bits, Deleter> const &p) = delete;
+
+    // Le déplacement transfère le pointeur et l'étiquette : p devient nul, d'étiquette 0
+    tagged_ptr(tagged_ptr<T, Bits, Deleter> &&p) noexcept;
+
+    ~tagged_ptr();
+
+    tagged_ptr<T, Bits, Deleter> &operator=(tagged_ptr<T, Bits, Deleter> const &p) = delete;
+
+    tagged_ptr<T, Bits, Deleter> &operator=(tagged_ptr<T, Bits, Deleter> &&p) noexcept;
+
+    // Rend le pointeur (sans étiquette) et devient nul ; l'étiquette est conservée
+    T *release();
+
+    // Échange pointeurs, étiquettes et destructeurs
+    void echange(tagged_ptr<T, Bits, Deleter> &p);
+
+    T *get() const;
+
+    unsigned tag() const;
+
+    // Seuls les Bits bits de poids faible de tag sont conservés
+    void set_tag(unsigned tag);
+
+    // Vrai si le pointeur est non nul, quelle que soit l'étiquette
+    explicit operator bool() const;
+
+    T &operator*() const;
+
+    T *operator->() const;
+
+    Deleter &get_deleter();
+};
+
+#include "tagged_ptr.tcc"
+
+
+#endif //TP9_TAGGED_PTR_HPP
@@ -0,0 +1,105 @@
+#ifndef TP9_TAGGED_PTR_TCC
+#define TP9_TAGGED_PTR_TCC
+
+
+template<class T, unsigned Bits, class Deleter>
+std::uintptr_t tagged_ptr<T, Bits, Deleter>::word(T *ptr, unsigned tag) {
+    // Ici T est complet, même s'il ne l'était pas à la déclaration du membre
+    static_assert(tagged_fits<T, Bits>::value, "Bits doit être compris entre 1 et log2(alignof(T))");
+    return reinterpret_cast<std::uintptr_t>(ptr) | (tag & tag_mask);
+}
+
+template<class T, unsigned Bits, class Deleter>
+void tagged_ptr<T, Bits, Deleter>::reset(T *ptr) {
+    T *old = get();
+    h.ptr = word(ptr, tag());
+    if (old != nullptr) {
+        h.deleter()(old);
+    }
+}
+
+template<class T, unsigned Bits, class Deleter>
+tagged_ptr<T, Bits, Deleter>::tagged_ptr(T *ptr, unsigned tag):h(word(ptr, tag), Deleter()) {}
+
+template<class T, unsigned Bits, class Deleter>
+tagged_ptr<T, Bits, Deleter>::tagged_ptr(T *ptr, unsigned tag, const Deleter &d):h(word(ptr, tag), d) {}
+
+template<class T, unsigned Bits, class Deleter>
+tagged_ptr<T, Bits, Deleter>::tagged_ptr(tagged_ptr<T, Bits, Deleter> &&p) noexcept
+        : h(p.h.ptr, p.get_deleter()) {
+    p.h.ptr = 0;
+}
+
+template<class T, unsigned Bits, class Deleter>
+tagged_ptr<T, Bits, Deleter>::~tagged_ptr() {
+    T *ptr = get();
+    if (ptr != nullptr) {
+        h.deleter()(ptr);
+    }
+}
+
+template<class T, unsigned Bits, class Deleter>
+tagged_ptr<T, Bits, Deleter> &tagged_ptr<T, Bits, Deleter>::operator=(tagged_ptr<T, Bits, Deleter> &&p) noexcept {
+    if (&p != this) {
+        reset(p.release());
+        set_tag(p.tag());
+        p.set_tag(0);
+        h.deleter() = p.get_deleter();
+    }
+    return *this;
+}
+
+template<class T, unsigned Bits, class Deleter>
+T *tagged_ptr<T, Bits, Deleter>::release() {
+    T *t = get();
+    h.ptr &= tag_mask;
+    return t;
+}
+
+template<class T, unsigned Bits, class Deleter>
+void tagged_ptr<T, Bits, Deleter>::echange(tagged_ptr<T, Bits, Deleter> &p) {
+    std::uintptr_t w = p.h.ptr;
+    p.h.ptr = h.ptr;
+    h.ptr = w;
+    Deleter d = p.get_deleter();
+    p.get_deleter() = get_deleter();
+    get_deleter() = d;
+}
+
+template<class T, unsigned Bits, class Deleter>
+T *tagged_ptr<T, Bits, Deleter>::get() const {
+    return reinterpret_cast<T *>(h.ptr & ~tag_mask);
+}
+
+template<class T, unsigned Bits, class Deleter>
+unsigned tagged_ptr<T, Bits, Deleter>::tag() const {
+    return static_cast<unsigned>(h.ptr & tag_mask);
+}
+
+template<class T, unsigned Bits, class Deleter>
+void tagged_ptr<T, Bits, Deleter>::set_tag(unsigned tag) {
+    h.ptr = (h.ptr & ~tag_mask) | (tag & tag_mask);
+}
+
+template<class T, unsigned Bits, class Deleter>
+tagged_ptr<T, Bits, Deleter>::operator bool() const {
+    return (h.ptr & ~tag_mask) != 0;
+}
+
+template<class T, unsigned Bits, class Deleter>
+T &tagged_ptr<T, Bits, Deleter>::operator*() const {
+    return *get();
+}
+
+template<class T, unsigned Bits, class Deleter>
+T *tagged_ptr<T, Bits, Deleter>::operator->() const {
+    return get();
+}
+
+template<class T, unsigned Bits, class Deleter>
+Deleter &tagged_ptr<T, Bits, Deleter>::get_deleter() {
+    return h.deleter();
+}
+
+
+#endif //TP9_TAGGED_PTR_TCC
@@ -0,0 +1,35 @@
+#include <cstdio>
+#include "../tagged_ptr.hpp"
+
+/* Types refusés à la compilation par tagged_ptr (cf. CMakeLists.txt) :
+ * TAGGED_CASE choisit le cas ; chacun doit échouer sur le static_assert de tagged_ptr.
+ * TAGGED_CASE == 0 est le témoin, qui compile et s'exécute.
+ *
+ * 1 : char, aucun bit libre (Bits par défaut : 0)
+ * 2 : int, 2 bits libres seulement
+ * 3 : struct de char, aucun bit libre
+ * 4 : trop de bits pour tout type, refusé dès l'instanciation de la classe (sans constructeur)
+ */
+
+struct Packed {
+    char c[3];
+};
+
+int main() {
+#if TAGGED_CASE == 1
+    tagged_ptr<char> p(new char);
+#elif TAGGED_CASE == 2
+    tagged_ptr<int, 3> p(new int);
+#elif TAGGED_CASE == 3
+    tagged_ptr<Packed, 1> p(new Packed);
+#elif TAGGED_CASE == 4
+    return sizeof(tagged_ptr<long, 9>) == 0;
+#else
+    tagged_ptr<int, 2> p(new int{7}, 3);
+    if (*p != 7 || p.tag() != 3) {
+        std::printf("tagged_ptr<int, 2> incorrect\n");
+        return 1;
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "bench.hpp"
+
+/* Compte les allocations sur le tas en remplaçant les opérateurs new/delete globaux.
+ * À n'inclure que dans le fichier contenant main (un seul remplacement par programme).
+ */
+
+namespace bench {
+
+    inline std::atomic<std::size_t> &allocationCount() {
+        static std::atomic<std::size_t> count{0};
+        return count;
+    }
+
+    // Comme run, en affichant aussi le nombre moyen d'allocations par itération
+    template<class F>
+    double runCounted(const char *name, long n, F f) {
+        std::size_t before = allocationCount().load();
+        double ns = run(name, n, f);
+        std::size_t after = allocationCount().load();
+        std::printf("%-48s %12s    %10.2f alloc/it\n", "", "", (double) (after - before) / (double) n);
+        return ns;
+    }
+
+}
+
+/* noinline : sinon GCC, voyant operator new inliné en malloc et operator delete en free,
+ * signale à tort des paires new/free incohérentes (-Wmismatched-new-delete).
+ */
+__attribute__((noinline)) void *operator new(std::size_t size) {
+    bench::allocationCount().fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+
+#endif
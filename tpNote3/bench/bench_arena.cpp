@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_arena.hpp"
+
+/* Latence par requête : chaque requête crée 1000 optionnels (of, copie, filter),
+ * les garde jusqu'à sa fin puis les détruit tous.
+ *
+ * - heap_storage<T> : une allocation et une libération par valeur (malloc de la glibc)
+ * - heap_storage<T, pool_allocation> : liste d'emplacements libres par thread
+ * - arena_optional<T> : valeurs dans une arène, libérée en bloc à la fin de la requête
+ *
+ * On affiche la latence moyenne, médiane et au 99e centile.
+ */
+
+struct Big {
+    long v[16];
+};
+
+static const int per_request = 1000;
+
+template<class Opt, class T>
+static void handle(std::vector<Opt> &kept, T &value) {
+    for (int i = 0; i < per_request / 2; i++) {
+        Opt o = Opt::of(value);
+        kept.push_back(o);
+        kept.push_back(o.filter([](const T &) { return true; }));
+    }
+    bench::doNotOptimize(kept);
+    kept.clear();
+}
+
+static void report(const char *name, std::vector<double> &latencies) {
+    double total = 0;
+    for (double l : latencies) {
+        total += l;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-40s %10.2f us/requête (médiane %8.2f, p99 %8.2f)\n", name,
+                total / (double) latencies.size() / 1000.0,
+                latencies[latencies.size() / 2] / 1000.0,
+                latencies[latencies.size() * 99 / 100] / 1000.0);
+}
+
+template<class Opt, class T, class Scope>
+static void requests(const char *name, long n, T value, Scope scope) {
+    std::vector<Opt> kept;
+    kept.reserve(per_request);
+    std::vector<double> latencies;
+    latencies.reserve(n);
+    for (long r = 0; r < n; r++) {
+        auto start = std::chrono::steady_clock::now();
+        scope([&]() {
+            handle<Opt>(kept, value);
+        });
+        auto stop = std::chrono::steady_clock::now();
+        latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    report(name, latencies);
+}
+
+template<class T>
+static void compare(const char *type_name, long n, T value) {
+    auto plain = [](const std::function<void()> &f) { f(); };
+    lib::arena a;
+    auto scoped = [&](const std::function<void()> &f) {
+        lib::arena_scope scope(a);
+        f();
+    };
+    std::string label = std::string("heap_storage<") + type_name + "> malloc";
+    requests<lib::optional<T, lib::heap_storage<T> > >(label.c_str(), n, value, plain);
+    label = std::string("heap_storage<") + type_name + "> pool";
+    requests<lib::optional<T, lib::heap_storage<T, lib::pool_allocation> > >(label.c_str(), n, value, plain);
+    label = std::string("arena_optional<") + type_name + ">";
+    requests<lib::arena_optional<T> >(label.c_str(), n, value, scoped);
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 20000);
+
+    Big big{};
+    compare<Big>("Big", n, big);
+
+    // La chaîne alloue son propre tampon : seul l'emplacement de la valeur est dans l'arène
+    compare<std::string>("std::string", n, std::string(40, 'x'));
+
+    return 0;
+}
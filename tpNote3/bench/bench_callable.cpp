@@ -0,0 +1,47 @@
+#include <functional>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_stack.hpp"
+
+/* map/filter : std::function contre appelable générique (template).
+ *
+ * Côté std::function, la lambda est convertie à chaque appel comme le fait
+ * l'appelant qui passe une lambda à filter(std::function<bool(T)>) :
+ * effacement de type, appel indirect et, pour une capture de plus de 16 octets,
+ * une allocation.
+ */
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 10000000);
+    int value = 4;
+    lib::optional<int> o = lib::optional<int>::of(value);
+    lib::optional_stack<int> os = lib::optional_stack<int>::of(value);
+    long a = 1, b = 2, c = 3; // capture de 24 octets
+
+    auto plain = [](int x) { return x % 2 == 0; };
+    auto captured = [a, b, c](int x) { return (x + a + b + c) % 2 == 0; };
+    auto twice = [](int x) { return new int(2 * x); };
+
+    bench::run("optional::filter std::function, sans capture", n, [&](long) {
+        bench::doNotOptimize(o.filter(std::function<bool(int)>(plain)));
+    });
+    bench::run("optional::filter template, sans capture", n, [&](long) {
+        bench::doNotOptimize(o.filter(plain));
+    });
+    bench::run("optional::filter std::function, avec capture", n, [&](long) {
+        bench::doNotOptimize(o.filter(std::function<bool(int)>(captured)));
+    });
+    bench::run("optional::filter template, avec capture", n, [&](long) {
+        bench::doNotOptimize(o.filter(captured));
+    });
+
+    bench::run("optional_stack filter.map std::function", n, [&](long) {
+        bench::doNotOptimize(os.filter(std::function<bool(int)>(captured))
+                                     .map(std::function<int *(int)>(twice)));
+    });
+    bench::run("optional_stack filter.map template", n, [&](long) {
+        bench::doNotOptimize(os.filter(captured).map(twice));
+    });
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include "bench.hpp"
+#include "../include/optional_stack.hpp"
+
+/* Table de correspondance opcode -> informations du gestionnaire, 64K entrées de type
+ * lib::optional_stack<HandlerInfo> (vide pour les opcodes non attribués).
+ *
+ * - table constexpr : calculée à la compilation, placée dans .rodata, rien à exécuter
+ *   au démarrage ; son contenu est vérifié par des static_assert
+ * - table à l'exécution : même calcul, effectué au démarrage (initialiseur dynamique)
+ *
+ * On mesure le coût de l'initialisation à l'exécution, puis celui d'une recherche
+ * dans chacune des deux tables.
+ *
+ * Compilé en C++14 (std::index_sequence, boucles dans les fonctions constexpr) ;
+ * l'en-tête reste en C++11.
+ */
+
+struct HandlerInfo {
+    int arity;
+    int cost;
+};
+
+static_assert(std::is_same<lib::compact_storage<HandlerInfo>::type, lib::trivial_storage<HandlerInfo> >::value,
+              "HandlerInfo doit utiliser trivial_storage");
+
+// Un opcode sur 4 n'est pas attribué
+constexpr lib::optional_stack<HandlerInfo> lookup(unsigned op) {
+    return op % 4 == 3
+           ? lib::optional_stack<HandlerInfo>::empty()
+           : lib::optional_stack<HandlerInfo>::of(HandlerInfo{static_cast<int>(op >> 14), static_cast<int>(op % 97)});
+}
+
+// Foncteurs constexpr : en C++14 les lambdas ne peuvent pas être appelées à la compilation
+struct IsCheap {
+    constexpr bool operator()(const HandlerInfo &h) const {
+        return h.cost < 50;
+    }
+};
+
+struct Cost {
+    constexpr int operator()(const HandlerInfo &h) const {
+        return h.cost;
+    }
+};
+
+constexpr unsigned rows = 256;
+constexpr unsigned columns = 256;
+constexpr unsigned entries = rows * columns;
+
+struct Row {
+    lib::optional_stack<HandlerInfo> e[columns];
+};
+
+struct Table {
+    Row r[rows];
+
+    constexpr const lib::optional_stack<HandlerInfo> &operator[](unsigned op) const {
+        return r[op / columns].e[op % columns];
+    }
+};
+
+/* optional_stack n'a pas de constructeur public par défaut : le tableau est construit
+ * élément par élément par expansion de paquets, ligne par ligne (paquets de 256).
+ */
+template<std::size_t... C>
+constexpr Row makeRow(unsigned row, unsigned seed, std::index_sequence<C...>) {
+    return Row{{lookup((row * columns + C) ^ seed)...}};
+}
+
+template<std::size_t... R>
+constexpr Table makeTable(unsigned seed, std::index_sequence<R...>) {
+    return Table{{makeRow(R, seed, std::make_index_sequence<columns>())...}};
+}
+
+constexpr Table makeTable(unsigned seed) {
+    return makeTable(seed, std::make_index_sequence<rows>());
+}
+
+constexpr long countPresent(const Table &table) {
+    long n = 0;
+    for (unsigned op = 0; op < entries; op++) {
+        n += table[op].isPresent() ? 1 : 0;
+    }
+    return n;
+}
+
+constexpr Table compiled = makeTable(0);
+
+static_assert(countPresent(compiled) == entries / 4 * 3, "3 opcodes sur 4 attribués");
+static_assert(compiled[3].isEmpty() && !compiled[3], "opcode 3 non attribué");
+static_assert((*compiled[0xFFFE]).arity == 3, "arité de l'opcode 0xFFFE");
+static_assert(compiled[196].orElse(HandlerInfo{-1, -1}).cost == 2, "coût de l'opcode 196");
+static_assert(compiled[7].orElse(HandlerInfo{-1, -1}).cost == -1, "orElse sur une entrée vide");
+static_assert(compiled[196].filter(IsCheap()).transform(Cost()).orElse(-1) == 2, "filter puis transform");
+static_assert(compiled[96].filter(IsCheap()).isEmpty(), "filter écarte les gestionnaires coûteux");
+static_assert(lib::optional_stack<HandlerInfo>::ofNullable(nullptr).isEmpty(), "ofNullable(nullptr)");
+
+// Scalaires flottants : niche constexpr (ou trivial_storage sans __builtin_bit_cast)
+constexpr lib::optional_stack<double> half = lib::optional_stack<double>::of(0.5);
+constexpr lib::optional_stack<float> noFloat = lib::optional_stack<float>::empty();
+static_assert(half.isPresent() && *half == 0.5 && half.orElse(1.0) == 0.5, "optional_stack<double>");
+static_assert(lib::optional_stack<double>::empty().orElse(2.0) == 2.0, "optional_stack<double> vide");
+static_assert(noFloat.isEmpty() && noFloat.orElse(1.5f) == 1.5f, "optional_stack<float> vide");
+
+// Même table, initialisée au démarrage : seed n'est connu qu'à l'exécution
+static unsigned runtimeSeed() {
+    volatile unsigned seed = 0;
+    return seed;
+}
+
+static const Table runtime = makeTable(runtimeSeed());
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 20000000);
+
+    for (unsigned op = 0; op < entries; op++) {
+        if (runtime[op].isPresent() != compiled[op].isPresent()
+            || runtime[op].orElse(HandlerInfo{-1, -1}).cost != compiled[op].orElse(HandlerInfo{-1, -1}).cost) {
+            std::printf("tables différentes à l'opcode %u\n", op);
+            std::exit(1);
+        }
+    }
+
+    static Table rebuilt = compiled;
+    long passes = n / entries + 1;
+    bench::runBatch("initialisation à l'exécution (par entrée)", passes, entries, [&]() {
+        rebuilt = makeTable(runtimeSeed());
+        bench::doNotOptimize(rebuilt);
+    });
+    std::printf("%-48s %12u elt %10.3f ns/elt (calculée à la compilation)\n", "initialisation constexpr", entries, 0.0);
+
+    long sum = 0;
+    unsigned mask = entries - 1;
+    bench::run("recherche table constexpr", n, [&](long i) {
+        sum += compiled[(unsigned) (i * 7919) & mask].transform(Cost()).orElse(0);
+    });
+    bench::run("recherche table initialisée à l'exécution", n, [&](long i) {
+        sum += runtime[(unsigned) (i * 7919) & mask].transform(Cost()).orElse(0);
+    });
+    bench::doNotOptimize(sum);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_cow.hpp"
+
+/* Diffusion ("fan-out") d'une grosse configuration (4 Ko) à de nombreux lecteurs.
+ *
+ * - un thread : à chaque tour, le producteur crée un optional, en distribue une copie
+ *   à chacun des 16 lecteurs qui lisent quelques champs, puis modifie sa propre copie
+ *   (mutableValue : avec cow_storage, c'est la seule copie effective de la valeur)
+ * - plusieurs threads : 256 configurations publiées, que 4 threads lecteurs copient
+ *   et lisent chacun en parallèle (compteur atomique obligatoire)
+ *
+ * heap_storage (copie profonde) contre cow_storage avec compteur local et atomique.
+ * On affiche aussi le nombre d'octets de Config copiés par tour.
+ */
+
+static std::atomic<long> copied_bytes{0};
+
+struct Config {
+    long v[512];
+
+    Config() {
+        for (long i = 0; i < 512; i++) {
+            v[i] = i;
+        }
+    }
+
+    Config(const Config &other) {
+        std::memcpy(v, other.v, sizeof(v));
+        copied_bytes.fetch_add(sizeof(v), std::memory_order_relaxed);
+    }
+};
+
+static const int readers = 16;
+
+template<class Opt>
+static void fanOut(const char *name, long rounds) {
+    std::vector<Opt> consumers(readers, Opt::empty());
+    Config config;
+    long sum = 0;
+    long before = copied_bytes.load();
+    double ns = bench::run(name, rounds, [&](long i) {
+        Opt produced = Opt::of(config);
+        for (Opt &c : consumers) {
+            c = produced;
+            sum += c->v[i % 512];
+        }
+        produced.mutableValue().v[0] = i;
+        sum += produced->v[0];
+    });
+    bench::doNotOptimize(sum);
+    long bytes = copied_bytes.load() - before;
+    std::printf("%-48s %12.0f octets copiés/tour %8.2f Mcopies/s\n", "", (double) bytes / (double) rounds,
+                readers * 1e3 / ns);
+}
+
+template<class Opt>
+static void threads(const char *name, long rounds) {
+    const int count = 4;
+    Config config;
+    std::vector<Opt> published;
+    for (int i = 0; i < 256; i++) {
+        published.push_back(Opt::of(config));
+    }
+    long before = copied_bytes.load();
+    long copies = rounds / count;
+    double ns = bench::runBatch(name, 1, copies * count, [&]() {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < count; t++) {
+            pool.push_back(std::thread([&, t]() {
+                long sum = 0;
+                for (long i = 0; i < copies; i++) {
+                    Opt local = published[(i + t) % published.size()];
+                    sum += local->v[i % 512];
+                }
+                bench::doNotOptimize(sum);
+            }));
+        }
+        for (std::thread &th : pool) {
+            th.join();
+        }
+    });
+    long bytes = copied_bytes.load() - before;
+    std::printf("%-48s %12.0f octets copiés/copie %8.2f Mcopies/s\n", "", (double) bytes / (double) (copies * count),
+                1e3 / ns);
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 200000);
+
+    fanOut<lib::optional<Config, lib::heap_storage<Config> > >("fan-out heap_storage", n);
+    fanOut<lib::optional<Config, lib::cow_storage<Config, lib::local_refcount> > >("fan-out cow_storage local", n);
+    fanOut<lib::cow_optional<Config> >("fan-out cow_storage atomique", n);
+
+    threads<lib::optional<Config, lib::heap_storage<Config> > >("4 threads heap_storage", n * readers);
+    threads<lib::cow_optional<Config> >("4 threads cow_storage atomique", n * readers);
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include "bench.hpp"
+#include "../include/expected.hpp"
+#include "../include/optional_stack.hpp"
+
+/* Chemin d'échec : lecture de mesures dont une partie est invalide.
+ *
+ * - throw/catch : parse retourne un optional_stack, orElseThrow lève une exception
+ *   sur les mesures invalides, rattrapée par l'appelant
+ * - expected : parse retourne un lib::expected<Reading, parse_error>, l'appelant teste
+ *   le résultat et lit l'erreur
+ *
+ * Taux d'échec de 0 %, 0,1 %, 1 %, 10 % et 50 %.
+ *
+ * Compilé deux fois : bench_expected, et bench_expected_noexcept sous -fno-exceptions
+ * (seule la version expected est alors mesurée).
+ */
+
+enum class parse_error {
+    out_of_range, checksum
+};
+
+struct Reading {
+    long value;
+    int sensor;
+};
+
+typedef lib::expected<Reading, parse_error> Result;
+
+static_assert(std::is_trivially_copyable<Result>::value, "expected de types triviaux");
+
+// Quelques vérifications à la compilation
+struct Double {
+    constexpr long operator()(const Reading &r) const {
+        return r.value * 2;
+    }
+};
+
+struct Positive {
+    constexpr bool operator()(const Reading &r) const {
+        return r.value > 0;
+    }
+};
+
+constexpr Result ok = Result::of(Reading{21, 1});
+constexpr Result failed = Result::failure(parse_error::checksum);
+static_assert(ok.isPresent() && !failed, "présence");
+static_assert(failed.error() == parse_error::checksum, "erreur");
+static_assert(ok.map(Double()).orElse(0) == 42, "map");
+static_assert(failed.map(Double()).error() == parse_error::checksum, "map propage l'erreur");
+static_assert(ok.filter(Positive(), parse_error::out_of_range).isPresent(), "filter");
+static_assert(Result::of(Reading{-1, 1}).filter(Positive(), parse_error::out_of_range).error()
+              == parse_error::out_of_range, "filter remplace la valeur par l'erreur");
+static_assert(failed.orElse(Reading{7, 0}).value == 7, "orElse");
+
+// Mesure invalide pour failures_per_million mesures sur un million
+static bool invalid(long i, long failures_per_million) {
+    return (unsigned long) (i * 2654435761L) % 1000000 < (unsigned long) failures_per_million;
+}
+
+__attribute__((noinline))
+static Result parseExpected(long i, long failures_per_million) {
+    if (invalid(i, failures_per_million)) {
+        return Result::failure(i % 2 == 0 ? parse_error::out_of_range : parse_error::checksum);
+    }
+    return Result::of(Reading{i % 1000, (int) (i % 8)});
+}
+
+static long scaled(const Reading &r) {
+    return r.value * 3 + r.sensor;
+}
+
+#if LIB_OPTIONAL_EXCEPTIONS
+
+__attribute__((noinline))
+static lib::optional_stack<Reading> parseOptional(long i, long failures_per_million) {
+    if (invalid(i, failures_per_million)) {
+        return lib::optional_stack<Reading>::empty();
+    }
+    return lib::optional_stack<Reading>::of(Reading{i % 1000, (int) (i % 8)});
+}
+
+static long withExceptions(long n, long failures_per_million, long &failures) {
+    long sum = 0;
+    char label[64];
+    std::snprintf(label, sizeof(label), "throw/catch, %.1f %% d'échecs", failures_per_million / 1e4);
+    bench::run(label, n, [&](long i) {
+        try {
+            sum += parseOptional(i, failures_per_million).transform(scaled).orElseThrow();
+        } catch (const std::runtime_error &) {
+            failures++;
+        }
+    });
+    return sum;
+}
+
+#endif
+
+static long withExpected(long n, long failures_per_million, long &failures, long &checksums) {
+    long sum = 0;
+    char label[64];
+    std::snprintf(label, sizeof(label), "expected, %.1f %% d'échecs", failures_per_million / 1e4);
+    bench::run(label, n, [&](long i) {
+        lib::expected<long, parse_error> r = parseExpected(i, failures_per_million).map(scaled);
+        if (r) {
+            sum += *r;
+        } else {
+            failures++;
+            checksums += r.error() == parse_error::checksum ? 1 : 0;
+        }
+    });
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 2000000);
+    const long rates[] = {0, 1000, 10000, 100000, 500000};
+
+    for (long rate : rates) {
+        long failures = 0;
+        long checksums = 0;
+        long sum = withExpected(n, rate, failures, checksums);
+        bench::doNotOptimize(sum);
+#if LIB_OPTIONAL_EXCEPTIONS
+        long thrown = 0;
+        if (withExceptions(n, rate, thrown) != sum || thrown != failures) {
+            std::printf("résultats différents entre throw/catch et expected\n");
+            return 1;
+        }
+#endif
+        if (failures > 0 && (checksums == 0 || checksums == failures)) {
+            std::printf("erreurs incorrectes\n");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <string>
+#include <utility>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_stack.hpp"
+
+/* Copies et déplacements de la valeur encapsulée, avec et sans sémantique de déplacement.
+ *
+ * Counted compte ses constructions par copie et par déplacement. Pour chaque scénario
+ * on compare l'appel sur une lvalue (copie) et sur une rvalue (std::move / temporaire).
+ */
+
+struct Counted {
+    static long copies;
+    static long moves;
+
+    std::string payload;
+
+    explicit Counted(const std::string &payload) : payload(payload) {}
+
+    Counted(const Counted &other) : payload(other.payload) {
+        copies++;
+    }
+
+    Counted(Counted &&other) noexcept : payload(std::move(other.payload)) {
+        moves++;
+    }
+
+    Counted &operator=(const Counted &other) {
+        payload = other.payload;
+        copies++;
+        return *this;
+    }
+
+    Counted &operator=(Counted &&other) noexcept {
+        payload = std::move(other.payload);
+        moves++;
+        return *this;
+    }
+};
+
+long Counted::copies = 0;
+long Counted::moves = 0;
+
+template<class F>
+static void measure(const char *name, long n, F f) {
+    Counted::copies = 0;
+    Counted::moves = 0;
+    bench::run(name, n, f);
+    std::printf("%-48s %12s    %6.2f copies/it %6.2f moves/it\n", "", "",
+                (double) Counted::copies / (double) n, (double) Counted::moves / (double) n);
+}
+
+template<class Opt>
+static void scenarios(const char *prefix, long n) {
+    Counted value{std::string(64, 'x')}; // chaîne hors "small string" : chaque copie alloue
+    auto keep = [](const Counted &c) { return !c.payload.empty(); };
+    std::string name;
+
+    name = std::string(prefix) + " filter (lvalue)";
+    measure(name.c_str(), n, [&](long) {
+        Opt o = Opt::of(value);
+        Opt filtered = o.filter(keep);
+        bench::doNotOptimize(filtered);
+    });
+    name = std::string(prefix) + " filter (rvalue)";
+    measure(name.c_str(), n, [&](long) {
+        Opt filtered = Opt::of(value).filter(keep);
+        bench::doNotOptimize(filtered);
+    });
+    name = std::string(prefix) + " orElseThrow (lvalue)";
+    measure(name.c_str(), n, [&](long) {
+        Opt o = Opt::of(value);
+        Counted c = o.orElseThrow();
+        bench::doNotOptimize(c);
+    });
+    name = std::string(prefix) + " orElseThrow (rvalue)";
+    measure(name.c_str(), n, [&](long) {
+        Opt o = Opt::of(value);
+        Counted c = std::move(o).orElseThrow();
+        bench::doNotOptimize(c);
+    });
+    name = std::string(prefix) + " passage par valeur (copie)";
+    measure(name.c_str(), n, [&](long) {
+        Opt o = Opt::of(value);
+        Opt passed = o;
+        bench::doNotOptimize(passed);
+    });
+    name = std::string(prefix) + " passage par valeur (std::move)";
+    measure(name.c_str(), n, [&](long) {
+        Opt o = Opt::of(value);
+        Opt passed = std::move(o);
+        bench::doNotOptimize(passed);
+    });
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 2000000);
+    scenarios<lib::optional<Counted> >("optional (heap)", n);
+    scenarios<lib::optional<Counted, lib::inline_storage<Counted> > >("optional (inline)", n);
+    scenarios<lib::optional_stack<Counted> >("optional_stack", n);
+    return 0;
+}
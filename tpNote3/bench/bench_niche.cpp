@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_stack.hpp"
+
+/* Empreinte mémoire de grands tableaux d'optionnels, avec et sans niche.
+ *
+ * optional_stack<T> emploie niche_storage dès que T déclare une valeur sentinelle :
+ * plus de booléen ni de remplissage, sizeof(optional_stack<T>) == sizeof(T).
+ * La référence "bool" est lib::optional<T, inline_storage<T>> (valeur + booléen).
+ */
+
+enum class Opcode : std::uint8_t {
+    Add, Sub, Mul, Div, Invalid
+};
+
+namespace lib {
+    template<>
+    struct niche_traits<Opcode> : enum_niche_traits<Opcode, Opcode::Invalid> {
+    };
+}
+
+// Sans __builtin_bit_cast, optional_stack<double> / <float> préfèrent trivial_storage (constexpr)
+#if LIB_OPTIONAL_CONSTEXPR_BIT_CAST
+static_assert(sizeof(lib::optional_stack<double>) == sizeof(double), "niche double");
+static_assert(sizeof(lib::optional_stack<float>) == sizeof(float), "niche float");
+#endif
+static_assert(sizeof(lib::optional_stack<int *>) == sizeof(int *), "niche pointeur");
+static_assert(sizeof(lib::optional_stack<Opcode>) == sizeof(Opcode), "niche enum");
+static_assert(sizeof(lib::optional_stack<int>) == 2 * sizeof(int), "int n'a pas de niche");
+static_assert(sizeof(lib::optional<double, lib::inline_storage<double> >) == 16, "valeur + booléen");
+
+template<class Opt, class T, class Make>
+static void footprint(const char *name, long n, Make make) {
+    std::vector<Opt> v;
+    v.reserve(n);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s remplissage", name);
+    bench::run(label, n, [&](long i) {
+        if (i % 4 == 3) {
+            v.push_back(Opt::empty());
+        } else {
+            T value = make(i);
+            v.push_back(Opt::of(value));
+        }
+    });
+    long present = 0;
+    std::snprintf(label, sizeof(label), "%s isPresent", name);
+    bench::run(label, n, [&](long i) {
+        present += v[i].isPresent();
+    });
+    bench::doNotOptimize(present);
+    std::printf("%-48s %12zu o/elt %10.1f Mo au total\n", name, sizeof(Opt),
+                (double) (sizeof(Opt) * v.size()) / (1024.0 * 1024.0));
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 10000000);
+    static int target = 0;
+
+    footprint<lib::optional<double, lib::inline_storage<double> >, double>(
+            "double + bool", n, [](long i) { return (double) i; });
+    footprint<lib::optional_stack<double>, double>(
+            "niche NaN double", n, [](long i) { return (double) i; });
+
+    footprint<lib::optional<int *, lib::inline_storage<int *> >, int *>(
+            "int * + bool", n, [](long) { return &target; });
+    footprint<lib::optional_stack<int *>, int *>(
+            "niche nullptr int *", n, [](long) { return &target; });
+
+    footprint<lib::optional<Opcode, lib::inline_storage<Opcode> >, Opcode>(
+            "Opcode + bool", n, [](long i) { return (Opcode) (i % 4); });
+    footprint<lib::optional_stack<Opcode>, Opcode>(
+            "niche Opcode::Invalid", n, [](long i) { return (Opcode) (i % 4); });
+
+    return 0;
+}
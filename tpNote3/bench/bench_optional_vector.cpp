@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional_stack.hpp"
+#include "../include/optional_vector.hpp"
+
+/* optional_vector<T> (valeurs + bitmap) contre std::vector<optional_stack<T>>.
+ *
+ * Pour chaque représentation : empreinte mémoire, remplissage (1 élément sur 4 absent),
+ * somme des valeurs présentes et comptage des éléments présents.
+ */
+
+static const long passes = 10;
+
+template<class T>
+static void rows(const char *name, long n) {
+    std::vector<lib::optional_stack<T> > v;
+    v.reserve(n);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s remplissage", name);
+    bench::run(label, n, [&](long i) {
+        T value = (T) i;
+        v.push_back(i % 4 == 3 ? lib::optional_stack<T>::empty() : lib::optional_stack<T>::of(value));
+    });
+    T sum = 0;
+    T zero = 0;
+    std::snprintf(label, sizeof(label), "%s somme", name);
+    bench::runBatch(label, passes, n, [&]() {
+        for (const lib::optional_stack<T> &o : v) {
+            sum += o.orElse(zero);
+        }
+    });
+    long present = 0;
+    std::snprintf(label, sizeof(label), "%s comptage", name);
+    bench::runBatch(label, passes, n, [&]() {
+        for (const lib::optional_stack<T> &o : v) {
+            present += o.isPresent();
+        }
+    });
+    bench::doNotOptimize(sum);
+    bench::doNotOptimize(present);
+    std::printf("%-48s %12.1f Mo\n", name, (double) (sizeof(v[0]) * v.size()) / (1024.0 * 1024.0));
+}
+
+template<class T>
+static void columns(const char *name, long n) {
+    lib::optional_vector<T> v;
+    v.reserve(n);
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s remplissage", name);
+    bench::run(label, n, [&](long i) {
+        if (i % 4 == 3) {
+            v.push_back_empty();
+        } else {
+            v.push_back((T) i);
+        }
+    });
+    T sum = 0;
+    std::snprintf(label, sizeof(label), "%s somme", name);
+    const T *values = v.data();
+    const std::uint64_t *validity = v.validityData();
+    bench::runBatch(label, passes, n, [&]() {
+        for (long i = 0; i < n; i++) {
+            // Sans branchement : la valeur est multipliée par son bit de présence
+            sum += values[i] * (T) ((validity[i / 64] >> (i % 64)) & 1);
+        }
+    });
+    std::size_t present = 0;
+    std::snprintf(label, sizeof(label), "%s countPresent", name);
+    bench::runBatch(label, passes, n, [&]() {
+        present += v.countPresent();
+    });
+    bench::doNotOptimize(sum);
+    bench::doNotOptimize(present);
+    double bytes = (double) (sizeof(T) * v.size() + sizeof(std::uint64_t) * ((v.size() + 63) / 64));
+    std::printf("%-48s %12.1f Mo\n", name, bytes / (1024.0 * 1024.0));
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 10000000);
+    rows<int>("vector<optional_stack<int>>", n);
+    columns<int>("optional_vector<int>", n);
+    rows<long>("vector<optional_stack<long>>", n);
+    columns<long>("optional_vector<long>", n);
+    rows<double>("vector<optional_stack<double>> (niche)", n);
+    columns<double>("optional_vector<double>", n);
+    return 0;
+}
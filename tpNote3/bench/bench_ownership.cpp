@@ -0,0 +1,33 @@
+#include <cstdio>
+#include <memory>
+#include "bench.hpp"
+#include "../include/optional_pt.hpp"
+
+/* Coût du suivi d'appartenance de optional_pt.hpp.
+ *
+ * Compilé deux fois (cf. CMakeLists.txt) :
+ * - bench_ownership : LIB_OPTIONAL_TRACK_OWNERSHIP=1 (registre actif)
+ * - bench_ownership_release : LIB_OPTIONAL_TRACK_OWNERSHIP=0 (aucun suivi)
+ * Sans suivi, construire/déplacer/détruire un optional doit coûter
+ * autant qu'avec un simple pointeur propriétaire (std::unique_ptr).
+ */
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 10000000);
+    std::printf("LIB_OPTIONAL_TRACK_OWNERSHIP = %d\n", LIB_OPTIONAL_TRACK_OWNERSHIP);
+
+    bench::run("std::unique_ptr<int> (new/move/delete)", n, [](long i) {
+        std::unique_ptr<int> p{new int((int) i)};
+        std::unique_ptr<int> moved = std::move(p);
+        bench::doNotOptimize(moved);
+    });
+
+    bench::run("lib::optional<int> (of/move/destruction)", n, [](long i) {
+        int value = (int) i;
+        lib::optional<int> o = lib::optional<int>::of(value);
+        lib::optional<int> moved = std::move(o);
+        bench::doNotOptimize(moved);
+    });
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional_stack.hpp"
+#include "../include/optional_pipeline.hpp"
+
+/* Chaînes de 3 et 5 étapes sur optional_stack<Payload>, terminées par orElse :
+ *
+ *   3 étapes : filter, map, filter
+ *   5 étapes : filter, map, filter, map, filter
+ *
+ * - forme immédiate : filter / transform de optional_stack, un optional_stack par étape
+ * - forme paresseuse : lib::lazy(o).filter(...).map(...)..., évaluée en une passe par orElse
+ *
+ * Payload (512 octets) compte ses copies ; il n'a pas de constructeur par déplacement,
+ * un déplacement est donc une copie (comme pour tout tableau de taille fixe).
+ * Les fonctions de map construisent un nouveau Payload sans copier leur argument.
+ * Une source sur 4 est vide.
+ */
+
+static long copies = 0;
+
+struct Payload {
+    long v[64];
+
+    explicit Payload(long seed) {
+        for (long i = 0; i < 64; i++) {
+            v[i] = seed + i;
+        }
+    }
+
+    Payload(const Payload &other) {
+        for (long i = 0; i < 64; i++) {
+            v[i] = other.v[i];
+        }
+        copies++;
+    }
+};
+
+static bool positive(const Payload &p) {
+    return p.v[0] >= 0;
+}
+
+static bool even(const Payload &p) {
+    return p.v[0] % 2 == 0;
+}
+
+static bool small(const Payload &p) {
+    return p.v[0] < 1000000;
+}
+
+static Payload twice(const Payload &p) {
+    return Payload(p.v[0] * 2);
+}
+
+static Payload next(const Payload &p) {
+    return Payload(p.v[0] + 1);
+}
+
+typedef lib::optional_stack<Payload> Opt;
+
+template<class Chain>
+static long measure(const char *name, const std::vector<Opt> &sources, long n, Chain chain) {
+    long sum = 0;
+    long before = copies;
+    bench::run(name, n, [&](long i) {
+        sum += chain(sources[i % sources.size()]).v[0];
+    });
+    std::printf("%-48s %12.2f copies/chaîne\n", "", (double) (copies - before) / (double) n);
+    bench::doNotOptimize(sum);
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 2000000);
+
+    std::vector<Opt> sources;
+    for (long i = 0; i < 1024; i++) {
+        Payload p(i * 7 - 100);
+        sources.push_back(i % 4 == 3 ? Opt::empty() : Opt::of(p));
+    }
+    const Payload fallback(-1);
+
+    long eager3 = measure("3 étapes, immédiate", sources, n, [&](const Opt &o) {
+        return o.filter(positive).transform(twice).filter(small).orElse(fallback);
+    });
+    long lazy3 = measure("3 étapes, paresseuse", sources, n, [&](const Opt &o) {
+        return lib::lazy(o).filter(positive).map(twice).filter(small).orElse(fallback);
+    });
+    long eager5 = measure("5 étapes, immédiate", sources, n, [&](const Opt &o) {
+        return o.filter(positive).transform(twice).filter(small).transform(next).filter(even).orElse(fallback);
+    });
+    long lazy5 = measure("5 étapes, paresseuse", sources, n, [&](const Opt &o) {
+        return lib::lazy(o).filter(positive).map(twice).filter(small).map(next).filter(even).orElse(fallback);
+    });
+    if (eager3 != lazy3 || eager5 != lazy5) {
+        std::printf("résultats différents entre formes immédiate et paresseuse\n");
+        return 1;
+    }
+
+    // Les autres terminaux
+    Opt first = sources[20];
+    bool ok = lib::lazy(first).map(twice).collect().orElse(fallback).v[0] == 2 * first.orElseThrow().v[0]
+              && lib::lazy(first).filter(even).filter(positive).collect().isPresent()
+              && lib::lazy(sources[3]).map(next).collect().isEmpty()
+              && lib::lazy(first).map(next).orElseThrow().v[0] == first.orElseThrow().v[0] + 1;
+    bool thrown = false;
+    try {
+        lib::lazy(first).filter(small).map(next).filter(even).orElseThrow();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    if (!ok || !thrown) {
+        std::printf("terminaux incorrects\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <string>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_allocator.hpp"
+
+/* lib::basic_optional<T, Alloc> avec std::allocator et avec std::pmr::polymorphic_allocator
+ * sur trois ressources : new_delete_resource (référence), unsynchronized_pool_resource et
+ * monotonic_buffer_resource sur un tampon fixe (libérée en bloc tous les 1000 tours).
+ *
+ * Chaque itération : of avec l'allocateur, affectation par copie dans un optional
+ * de la même ressource, filter sur le temporaire (déplacement), puis destruction.
+ *
+ * Compilé en C++17 (std::pmr) ; les en-têtes restent en C++11.
+ */
+
+struct Big {
+    long v[16];
+};
+
+// Avec std::allocator (vide), l'optional n'est pas plus gros qu'un pointeur
+static_assert(sizeof(lib::basic_optional<Big>) == sizeof(Big *), "EBO de l'allocateur");
+
+template<class T>
+using pmr_optional = lib::basic_optional<T, std::pmr::polymorphic_allocator<T> >;
+
+template<class Opt, class T, class Alloc>
+static void churn(const char *name, long n, T value, Alloc alloc) {
+    bench::run(name, n, [&](long) {
+        Opt o = Opt::of(value, alloc);
+        Opt copy = Opt::empty(alloc);
+        copy = o;
+        Opt kept = std::move(copy).filter([](const T &) { return true; });
+        bench::doNotOptimize(*kept);
+    });
+}
+
+// Référence : heap_storage, sans allocateur
+template<class T>
+static void churnHeap(const char *name, long n, T value) {
+    typedef lib::optional<T, lib::heap_storage<T> > Opt;
+    bench::run(name, n, [&](long) {
+        Opt o = Opt::of(value);
+        Opt copy = Opt::empty();
+        copy = o;
+        Opt kept = std::move(copy).filter([](const T &) { return true; });
+        bench::doNotOptimize(*kept);
+    });
+}
+
+// Propagation de l'allocateur, comme pour les conteneurs standards
+static void checkPropagation() {
+    std::pmr::unsynchronized_pool_resource pool;
+    std::pmr::monotonic_buffer_resource other;
+    Big big{};
+    pmr_optional<Big> o = pmr_optional<Big>::of(big, &pool);
+    // polymorphic_allocator ne se propage pas à la copie : ressource par défaut
+    pmr_optional<Big> copy = o;
+    // ... ni à l'affectation : la cible garde sa ressource
+    pmr_optional<Big> assigned = pmr_optional<Big>::empty(&other);
+    assigned = o;
+    // Le déplacement emporte l'allocateur
+    pmr_optional<Big> moved = std::move(o);
+    // Affectation par déplacement entre ressources différentes : copie dans la ressource de la cible
+    assigned = std::move(moved);
+    bool ok = copy.isPresent() && assigned.isPresent();
+    if (!ok) {
+        std::printf("propagation de l'allocateur incorrecte\n");
+        std::exit(1);
+    }
+}
+
+template<class T>
+static void compare(const char *type_name, long n, T value) {
+    std::string label = std::string("heap_storage<") + type_name + ">";
+    churnHeap<T>(label.c_str(), n, value);
+    label = std::string("basic_optional<") + type_name + ", std::allocator>";
+    churn<lib::basic_optional<T> >(label.c_str(), n, value, std::allocator<T>());
+
+    label = std::string("pmr ") + type_name + " new_delete_resource";
+    churn<pmr_optional<T> >(label.c_str(), n, value,
+                            std::pmr::polymorphic_allocator<T>(std::pmr::new_delete_resource()));
+
+    std::pmr::unsynchronized_pool_resource pool;
+    label = std::string("pmr ") + type_name + " unsynchronized_pool_resource";
+    churn<pmr_optional<T> >(label.c_str(), n, value, std::pmr::polymorphic_allocator<T>(&pool));
+
+    // Tampon initial assez grand pour 1000 tours : release() le réutilise sans rien allouer
+    static char buffer[1 << 20];
+    std::pmr::monotonic_buffer_resource monotonic(buffer, sizeof(buffer));
+    label = std::string("pmr ") + type_name + " monotonic_buffer_resource";
+    bench::run(label.c_str(), n, [&](long i) {
+        {
+            std::pmr::polymorphic_allocator<T> alloc(&monotonic);
+            pmr_optional<T> o = pmr_optional<T>::of(value, alloc);
+            pmr_optional<T> copy = pmr_optional<T>::empty(alloc);
+            copy = o;
+            pmr_optional<T> kept = std::move(copy).filter([](const T &) { return true; });
+            bench::doNotOptimize(*kept);
+        }
+        // Fin de "requête" : toute la mémoire de la ressource est rendue d'un coup
+        if (i % 1000 == 999) {
+            monotonic.release();
+        }
+    });
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 5000000);
+    checkPropagation();
+
+    Big big{};
+    compare<Big>("Big", n, big);
+
+    return 0;
+}
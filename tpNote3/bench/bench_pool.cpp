@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alloc_counter.hpp"
+#include "../include/optional.hpp"
+
+/* heap_storage avec l'allocateur global (new_allocation, donc malloc de la glibc)
+ * contre heap_storage avec pool_allocation (liste d'emplacements libres par thread).
+ *
+ * - churn : chaque itération fabrique un optional, le copie, le filtre puis détruit
+ *   les trois instances (trois allocations et trois libérations)
+ * - working set : 4096 optionals vivants, on en remplace un à chaque itération
+ *   (libérations et allocations entrelacées, dans le désordre)
+ * - threads : le churn exécuté en parallèle par 4 threads
+ */
+
+struct Big {
+    long v[32];
+};
+
+template<class T>
+using pooled = lib::optional<T, lib::heap_storage<T, lib::pool_allocation> >;
+
+template<class T>
+using global = lib::optional<T, lib::heap_storage<T> >;
+
+template<class Opt, class T, class Touch>
+static void churnLoop(long n, T value, Touch touch) {
+    for (long i = 0; i < n; i++) {
+        Opt o = Opt::of(value);
+        Opt copy = o;
+        Opt kept = copy.filter([&](const T &t) { return touch(t) >= 0; });
+        bench::doNotOptimize(touch(*kept));
+    }
+}
+
+template<class Opt, class T>
+static void workingSet(const char *name, long n, T value) {
+    std::vector<Opt> live(4096, Opt::empty());
+    unsigned long x = 88172645463325252ul;
+    bench::runCounted(name, n, [&](long) {
+        // xorshift : indice pseudo-aléatoire, les emplacements sont libérés dans le désordre
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        live[x % live.size()] = Opt::of(value);
+    });
+}
+
+template<class Opt, class T, class Touch>
+static void threads(const char *name, long n, T value, Touch touch) {
+    const int count = 4;
+    bench::runBatch(name, 1, n, [&]() {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < count; t++) {
+            pool.push_back(std::thread([&]() {
+                churnLoop<Opt>(n / count, value, touch);
+            }));
+        }
+        for (std::thread &t : pool) {
+            t.join();
+        }
+    });
+}
+
+template<class T, class Touch>
+static void compare(const char *type_name, long n, T value, Touch touch) {
+    char label[96];
+    std::snprintf(label, sizeof(label), "churn %s malloc", type_name);
+    bench::runCounted(label, n, [&](long) {
+        churnLoop<global<T> >(1, value, touch);
+    });
+    std::snprintf(label, sizeof(label), "churn %s pool", type_name);
+    bench::runCounted(label, n, [&](long) {
+        churnLoop<pooled<T> >(1, value, touch);
+    });
+    std::snprintf(label, sizeof(label), "working set %s malloc", type_name);
+    workingSet<global<T> >(label, n, value);
+    std::snprintf(label, sizeof(label), "working set %s pool", type_name);
+    workingSet<pooled<T> >(label, n, value);
+    std::snprintf(label, sizeof(label), "4 threads %s malloc", type_name);
+    threads<global<T> >(label, n, value, touch);
+    std::snprintf(label, sizeof(label), "4 threads %s pool", type_name);
+    threads<pooled<T> >(label, n, value, touch);
+
+    lib::pool_stats stats = lib::pool_allocation<T>::stats();
+    // Compteurs par classe de taille : ils incluent les autres types de même slot_size
+    std::printf("pool %s, classe de %zu octets (thread principal) : %zu succès, %zu défauts, %zu en cache\n",
+                type_name, lib::pool_allocation<T>::slot_size, stats.hits, stats.misses, stats.cached);
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 5000000);
+
+    Big big{};
+    big.v[0] = 1;
+    compare<Big>("Big", n, big, [](const Big &b) { return b.v[0]; });
+
+    // La chaîne elle-même alloue encore son tampon : seul l'emplacement de l'optional est recyclé
+    compare<std::string>("std::string", n, std::string(40, 'x'), [](const std::string &s) { return (long) s.size(); });
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+
+/* Recherche d'enregistrements de 1 Ko dans une table de hachage.
+ *
+ * - forme "valeur" : find retourne un lib::optional<Record>, la valeur est copiée
+ *   (sur le tas : Record dépasse la taille d'inline_storage)
+ * - forme "référence" : find retourne un lib::optional<Record &>, un simple pointeur
+ *
+ * Dans les deux cas, on lit un champ de l'enregistrement trouvé, ou d'un enregistrement
+ * par défaut (orElse) si la clé est absente (une recherche sur 4).
+ */
+
+struct Record {
+    long id;
+    char payload[1024 - sizeof(long)];
+};
+
+static_assert(sizeof(Record) == 1024, "Record doit faire 1 Ko");
+// optional<T &> n'est qu'un pointeur
+static_assert(sizeof(lib::optional<Record &>) == sizeof(Record *), "optional<T &> doit être un pointeur");
+
+typedef std::unordered_map<long, Record> Table;
+
+static lib::optional<Record> findValue(Table &table, long key) {
+    Table::iterator it = table.find(key);
+    return it == table.end() ? lib::optional<Record>::empty() : lib::optional<Record>::of(it->second);
+}
+
+static lib::optional<Record &> findReference(Table &table, long key) {
+    Table::iterator it = table.find(key);
+    return it == table.end() ? lib::optional<Record &>::empty() : lib::optional<Record &>::of(it->second);
+}
+
+// Sémantique de référence : mêmes objets, modifications visibles, affectation qui "re-lie"
+static void check(Table &table) {
+    lib::optional<Record &> r = findReference(table, 1);
+    r.orElseThrow().payload[0] = 'z';
+    lib::optional<Record &> other = findReference(table, 2);
+    r = other;
+    bool ok = &*other == &table[2]
+              && table[1].payload[0] == 'z'
+              && findReference(table, -1).isEmpty()
+              && r.map([](Record &rec) { return &rec.id; }).orElseThrow() == 2
+              && &r.transform([](Record &rec) -> long & { return rec.id; }).orElseThrow() == &table[2].id
+              && r.transform([](Record &rec) { return rec.id * 10; }).orElseThrow() == 20
+              && r.filter([](const Record &rec) { return rec.id == 3; }).isEmpty();
+    if (!ok) {
+        std::printf("optional<Record &> incorrect\n");
+        std::exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 5000000);
+    const long size = 4096;
+
+    Table table;
+    for (long i = 0; i < size; i++) {
+        Record r{};
+        r.id = i;
+        table[i] = r;
+    }
+    check(table);
+
+    Record fallback{};
+    fallback.id = -1;
+    long sum = 0;
+    // Clés de 0 à 4/3 * size : une recherche sur 4 échoue
+    bench::run("optional<Record> (copie)", n, [&](long i) {
+        long key = (i * 7919) % (size + size / 3);
+        sum += findValue(table, key).orElse(fallback).id;
+    });
+    bench::run("optional<Record &> (référence)", n, [&](long i) {
+        long key = (i * 7919) % (size + size / 3);
+        sum += findReference(table, key).orElse(fallback).id;
+    });
+    bench::doNotOptimize(sum);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <iostream>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional_pt.hpp"
+
+/* Passage à l'échelle du registre des pointeurs possédés (optional_pt.hpp).
+ *
+ * Pour N optionals vivants simultanément, on mesure le coût moyen :
+ * - de la construction (of : allocation + insertion dans le registre),
+ * - du déplacement (move constructor),
+ * - de la destruction (suppression du registre + delete).
+ * Avec un registre en O(1), ces coûts ne dépendent pas de N.
+ *
+ * N parcourt 10^3, 10^4, ... jusqu'à 10^7 ; le premier argument de la ligne de commande
+ * fixe un autre N maximal (ex : bench_registry 100000 pour s'arrêter à 10^5).
+ */
+
+int main(int argc, char **argv) {
+    // N maximal : 10^7 par défaut, ou le premier argument
+    long max_n = bench::iterations(argc, argv, 10000000);
+
+    for (long n = 1000; n <= max_n; n *= 10) {
+        std::cout << "N = " << n << "\n";
+        std::vector<lib::optional<int>> live;
+        live.reserve(n);
+        std::vector<lib::optional<int>> moved;
+        moved.reserve(n);
+        int value = 42;
+
+        bench::run("  construction (of)", n, [&](long i) {
+            value = (int) i;
+            live.push_back(lib::optional<int>::of(value));
+        });
+        bench::run("  deplacement (move)", n, [&](long i) {
+            moved.push_back(std::move(live[i]));
+        });
+        bench::run("  destruction", n, [&](long) {
+            moved.pop_back();
+        });
+        live.clear();
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional_pt.hpp"
+
+/* Stress multi-thread du registre partagé de optional_pt.hpp.
+ *
+ * 1. Débit : chaque thread construit (of), déplace puis détruit des optionals
+ *    en boucle ; on affiche le nombre d'itérations par seconde pour 1 à 16 threads.
+ * 2. Contention : tous les threads tentent de s'approprier le même pointeur,
+ *    un seul doit y parvenir (les autres reçoivent "Pointer is already owned").
+ */
+
+static double throughput(unsigned threads, long per_thread) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&go, per_thread, t]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            int value = (int) t;
+            for (long i = 0; i < per_thread; i++) {
+                lib::optional<int> o = lib::optional<int>::of(value);
+                lib::optional<int> moved = std::move(o);
+                bench::doNotOptimize(moved);
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (std::thread &th : pool) {
+        th.join();
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (double) (per_thread * threads) / s;
+}
+
+// Retourne le nombre de threads ayant réussi à s'approprier le même pointeur
+static int contend(unsigned threads) {
+    int *shared = new int{7};
+    std::atomic<bool> go{false};
+    std::vector<lib::optional<int>> owners;
+    for (unsigned t = 0; t < threads; t++) {
+        owners.push_back(lib::optional<int>::ofNullable(nullptr));
+    }
+    std::atomic<int> winners{0};
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            try {
+                owners[t] = lib::optional<int>::ofNullable(shared);
+                winners++;
+            } catch (std::runtime_error &error) {
+                // "Pointer is already owned" : un autre thread a gagné
+            }
+        });
+    }
+    go = true;
+    for (std::thread &th : pool) {
+        th.join();
+    }
+    return winners.load(); // owners libère shared une seule fois en étant détruit
+}
+
+int main(int argc, char **argv) {
+    long per_thread = bench::iterations(argc, argv, 1000000);
+    const unsigned counts[] = {1, 2, 4, 8, 16};
+
+    for (unsigned threads : counts) {
+        std::printf("%2u threads : %12.0f it/s\n", threads, throughput(threads, per_thread));
+    }
+
+    for (unsigned threads : counts) {
+        for (int round = 0; round < 1000; round++) {
+            int winners = contend(threads);
+            if (winners != 1) {
+                std::printf("ERREUR : %d threads possèdent le même pointeur\n", winners);
+                return 1;
+            }
+        }
+    }
+    std::printf("contention : un seul propriétaire par pointeur sur 5000 essais\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional_stack.hpp"
+#include "../include/optional_vector.hpp"
+#include "../include/optional_simd.hpp"
+
+/* filterCompare / mapAffine (par lots, optional_vector) contre l'API élément par élément
+ * (optional_stack::filter(bool(&)(T)) et transform sur un std::vector<optional_stack<T>>).
+ *
+ * Un élément sur 4 est absent. Le filtre garde x < 900 pour x = i % 1000 : après la
+ * première passe il n'élimine plus rien, chaque passe fait donc le même travail.
+ * Avant de mesurer, on vérifie que chaque jeu d'instructions donne le même résultat
+ * que la version scalaire.
+ */
+
+static const long passes = 20;
+
+static const char *levelName(lib::simd_level level) {
+    switch (level) {
+        case lib::simd_level::scalar:
+            return "scalaire";
+        case lib::simd_level::sse2:
+            return "sse2";
+        case lib::simd_level::avx2:
+            return "avx2";
+    }
+    return "?";
+}
+
+template<class T>
+static bool lessThan900(T x) {
+    return x < 900;
+}
+
+template<class T>
+static lib::optional_vector<T> makeColumns(long n) {
+    lib::optional_vector<T> v;
+    v.reserve(n);
+    for (long i = 0; i < n; i++) {
+        if (i % 4 == 3) {
+            v.push_back_empty();
+        } else {
+            v.push_back((T) (i % 1000));
+        }
+    }
+    return v;
+}
+
+template<class T>
+static bool sameColumns(const lib::optional_vector<T> &a, const lib::optional_vector<T> &b) {
+    return a.size() == b.size()
+           && std::memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0
+           && std::memcmp(a.validityData(), b.validityData(), sizeof(std::uint64_t) * ((a.size() + 63) / 64)) == 0;
+}
+
+// Toutes les comparaisons et le map, sur une taille qui n'est pas multiple de 64
+template<class T>
+static void check(const char *name) {
+    const lib::compare ops[] = {lib::compare::less, lib::compare::less_equal, lib::compare::greater,
+                                lib::compare::greater_equal, lib::compare::equal, lib::compare::not_equal};
+    const lib::simd_level levels[] = {lib::simd_level::sse2, lib::simd_level::avx2};
+    for (lib::compare op : ops) {
+        lib::optional_vector<T> expected = makeColumns<T>(1000 + 37);
+        lib::filterCompare(expected, op, (T) 500, lib::simd_level::scalar);
+        lib::mapAffine(expected, (T) 3, (T) -7, lib::simd_level::scalar);
+        for (lib::simd_level level : levels) {
+            lib::optional_vector<T> v = makeColumns<T>(1000 + 37);
+            lib::filterCompare(v, op, (T) 500, level);
+            lib::mapAffine(v, (T) 3, (T) -7, level);
+            if (!sameColumns(v, expected)) {
+                std::printf("%s : résultat %s différent du scalaire\n", name, levelName(level));
+                std::exit(1);
+            }
+        }
+    }
+}
+
+template<class T>
+static void run(const char *name, long n) {
+    check<T>(name);
+    char label[96];
+
+    std::vector<lib::optional_stack<T> > rows;
+    rows.reserve(n);
+    for (long i = 0; i < n; i++) {
+        T value = (T) (i % 1000);
+        rows.push_back(i % 4 == 3 ? lib::optional_stack<T>::empty() : lib::optional_stack<T>::of(value));
+    }
+    std::snprintf(label, sizeof(label), "%s filter (par élément)", name);
+    bench::runBatch(label, passes, n, [&]() {
+        for (lib::optional_stack<T> &o : rows) {
+            o = o.filter(lessThan900<T>);
+        }
+    });
+    std::snprintf(label, sizeof(label), "%s transform (par élément)", name);
+    bench::runBatch(label, passes, n, [&]() {
+        for (lib::optional_stack<T> &o : rows) {
+            o = o.transform([](const T &x) { return lib::affine_scalar(x, (T) 1, (T) 0); });
+        }
+    });
+
+    lib::optional_vector<T> columns = makeColumns<T>(n);
+    const lib::simd_level levels[] = {lib::simd_level::scalar, lib::simd_level::sse2, lib::simd_level::avx2};
+    for (lib::simd_level level : levels) {
+        if (level > lib::simdLevel()) {
+            continue;
+        }
+        std::snprintf(label, sizeof(label), "%s filterCompare (%s)", name, levelName(level));
+        bench::runBatch(label, passes, n, [&]() {
+            lib::filterCompare(columns, lib::compare::less, (T) 900, level);
+        });
+        std::snprintf(label, sizeof(label), "%s mapAffine (%s)", name, levelName(level));
+        bench::runBatch(label, passes, n, [&]() {
+            lib::mapAffine(columns, (T) 1, (T) 0, level);
+        });
+    }
+    bench::doNotOptimize(rows);
+    bench::doNotOptimize(columns);
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 10000000);
+    std::printf("jeu d'instructions détecté : %s\n", levelName(lib::simdLevel()));
+    run<std::int32_t>("int32", n);
+    run<std::int64_t>("int64", n);
+    run<float>("float", n);
+    run<double>("double", n);
+    return 0;
+}
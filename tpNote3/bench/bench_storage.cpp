@@ -0,0 +1,50 @@
+#include <iostream>
+#include <string>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+
+/* Compare les politiques de stockage de lib::optional :
+ * heap_storage (une allocation par fabrique et par copie) et
+ * inline_storage (aucune allocation).
+ *
+ * Chaque itération construit un optional via of, le copie,
+ * lit sa valeur puis détruit les deux instances.
+ */
+
+struct Pod64 {
+    long v[8];
+};
+
+static_assert(sizeof(Pod64) == 64, "Pod64 doit faire 64 octets");
+
+template<class T, class Storage, class Touch>
+static void churn(const char *name, long n, T value, Touch touch) {
+    bench::run(name, n, [&](long) {
+        lib::optional<T, Storage> o = lib::optional<T, Storage>::of(value);
+        lib::optional<T, Storage> copy = o;
+        bench::doNotOptimize(touch(*copy));
+    });
+}
+
+template<class T, class Touch>
+static void compare(const char *type_name, long n, T value, Touch touch) {
+    std::string heap = std::string("heap_storage<") + type_name + ">";
+    std::string inl = std::string("inline_storage<") + type_name + ">";
+    churn<T, lib::heap_storage<T>>(heap.c_str(), n, value, touch);
+    churn<T, lib::inline_storage<T>>(inl.c_str(), n, value, touch);
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 10000000);
+
+    compare<int>("int", n, 42, [](const int &i) { return i; });
+
+    Pod64 pod{};
+    pod.v[0] = 1;
+    compare<Pod64>("Pod64", n, pod, [](const Pod64 &p) { return p.v[0]; });
+
+    // Chaîne trop longue pour l'optimisation "small string" : la copie de T alloue aussi
+    compare<std::string>("std::string", n, std::string(40, 'x'), [](const std::string &s) { return s.size(); });
+
+    return 0;
+}
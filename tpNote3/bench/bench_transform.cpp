@@ -0,0 +1,77 @@
+#include <functional>
+#include <string>
+#include "alloc_counter.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_stack.hpp"
+
+/* map (f retourne un B* alloué) contre transform (f retourne un B).
+ *
+ * Reprend les scénarios AtoBMap/AtoBMapFun de src/main.cpp. Avec map, une
+ * transformation coûte l'allocation faite par f, la copie dans un nouvel optional
+ * puis la libération du pointeur retourné. transform construit B directement
+ * dans l'optional retourné : aucune allocation avec inline_storage ou optional_stack.
+ */
+
+class A {
+public:
+    int x;
+
+    explicit A(int x) : x(x) {}
+};
+
+class B {
+public:
+    std::string y;
+
+    explicit B(const std::string &y) : y(y) {}
+};
+
+static B *AtoBMapFun(A a) {
+    if (a.x > 0) {
+        return new B{"hello"};
+    }
+    return nullptr;
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 5000000);
+    A a{4};
+
+    std::function<auto(A) -> B *> AtoBMap = [](A a) -> B * {
+        return a.x > 0 ? new B{"hey"} : nullptr;
+    };
+    auto AtoB = [](const A &a) { return B{a.x > 0 ? "hey" : "ho"}; };
+    auto AtoOptB = [](const A &a) {
+        B b{"hey"};
+        return a.x > 0 ? lib::optional<B, lib::inline_storage<B> >::of(b)
+                       : lib::optional<B, lib::inline_storage<B> >::empty();
+    };
+
+    lib::optional<A, lib::heap_storage<A> > heap = lib::optional<A, lib::heap_storage<A> >::of(a);
+    lib::optional<A, lib::inline_storage<A> > inl = lib::optional<A, lib::inline_storage<A> >::of(a);
+    lib::optional_stack<A> stack = lib::optional_stack<A>::of(a);
+
+    bench::runCounted("optional<A> map(AtoBMap) [std::function]", n, [&](long) {
+        bench::doNotOptimize(inl.map(AtoBMap));
+    });
+    bench::runCounted("optional<A> map(AtoBMapFun)", n, [&](long) {
+        bench::doNotOptimize(inl.map(AtoBMapFun));
+    });
+    bench::runCounted("heap_storage transform(AtoB)", n, [&](long) {
+        bench::doNotOptimize(heap.transform(AtoB));
+    });
+    bench::runCounted("inline_storage transform(AtoB)", n, [&](long) {
+        bench::doNotOptimize(inl.transform(AtoB));
+    });
+    bench::runCounted("inline_storage transform(AtoOptB) [flat]", n, [&](long) {
+        bench::doNotOptimize(inl.transform(AtoOptB));
+    });
+    bench::runCounted("optional_stack map(AtoBMapFun)", n, [&](long) {
+        bench::doNotOptimize(stack.map(AtoBMapFun));
+    });
+    bench::runCounted("optional_stack transform(AtoB)", n, [&](long) {
+        bench::doNotOptimize(stack.transform(AtoB));
+    });
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "bench.hpp"
+#include "../include/optional.hpp"
+#include "../include/optional_stack.hpp"
+
+/* Optionnels trivialement copiables : croissance d'un std::vector et copie en bloc.
+ *
+ * Boxed a la même représentation qu'un int mais un constructeur par copie fourni par
+ * l'utilisateur : ses optionnels empruntent le chemin non trivial (copie valeur par valeur),
+ * comme le faisaient tous les optionnels avant la propagation de la trivialité.
+ *
+ * - croissance : push_back de 4096 optionnels sans reserve ; à chaque réallocation,
+ *   std::vector déplace les éléments par memmove s'ils sont trivialement copiables,
+ *   un par un sinon
+ * - copie en bloc vers un tampon d'octets (ex : tampon réseau) : un seul memcpy pour
+ *   les optionnels trivialement copiables, une copie élément par élément sinon
+ */
+
+struct Boxed {
+    int v;
+
+    Boxed(int v) : v{v} {}
+
+    Boxed(const Boxed &other) : v{other.v} {}
+
+    Boxed &operator=(const Boxed &other) {
+        v = other.v;
+        return *this;
+    }
+};
+
+static_assert(std::is_trivially_copyable<lib::optional<int> >::value, "optional<int>");
+static_assert(std::is_trivially_copyable<lib::optional_stack<int> >::value, "optional_stack<int>");
+static_assert(std::is_trivially_copyable<lib::optional<double, lib::inline_storage<double> > >::value,
+              "optional<double, inline_storage>");
+static_assert(!std::is_trivially_copyable<lib::optional<Boxed, lib::inline_storage<Boxed> > >::value,
+              "Boxed n'est pas trivialement copiable");
+static_assert(!std::is_trivially_copyable<lib::optional_stack<Boxed> >::value, "optional_stack<Boxed>");
+static_assert(sizeof(lib::optional<Boxed, lib::inline_storage<Boxed> >) == sizeof(lib::optional<int>),
+              "même taille");
+
+template<class Opt, class T>
+static std::vector<Opt> makeValues(long n) {
+    std::vector<Opt> values;
+    values.reserve(n);
+    for (long i = 0; i < n; i++) {
+        T value(static_cast<int>(i));
+        values.push_back(i % 4 == 3 ? Opt::empty() : Opt::of(value));
+    }
+    return values;
+}
+
+/* Vecteurs de 4096 éléments (quelques dizaines de Ko) : au-delà, le coût des défauts de page
+ * des grandes allocations neuves masquerait celui des réallocations.
+ * Les optionnels sont construits à l'avance : on ne mesure que push_back et les réallocations.
+ */
+template<class Opt, class T>
+static void growth(const char *name, long n) {
+    const long size = 4096;
+    std::vector<Opt> values = makeValues<Opt, T>(size);
+    bench::runBatch(name, n / size + 1, size, [&]() {
+        std::vector<Opt> v;
+        for (long i = 0; i < size; i++) {
+            v.push_back(values[i]);
+        }
+        bench::doNotOptimize(v.data());
+    });
+}
+
+// Copie en bloc : memcpy, permis uniquement pour un type trivialement copiable
+template<class Opt>
+static void copyBytes(unsigned char *buffer, const Opt *values, long n, std::true_type) {
+    std::memcpy(buffer, values, n * sizeof(Opt));
+}
+
+// Sinon : construction par copie de chaque optional dans le tampon
+template<class Opt>
+static void copyBytes(unsigned char *buffer, const Opt *values, long n, std::false_type) {
+    Opt *out = reinterpret_cast<Opt *>(buffer);
+    for (long i = 0; i < n; i++) {
+        new(out + i) Opt(values[i]);
+    }
+}
+
+template<class Opt, class T>
+static void bulkCopy(const char *name, long n) {
+    std::vector<Opt> values = makeValues<Opt, T>(n);
+    std::vector<unsigned char> buffer(n * sizeof(Opt));
+    bench::runBatch(name, 50, n, [&]() {
+        copyBytes(buffer.data(), values.data(), n, std::is_trivially_copyable<Opt>());
+        bench::doNotOptimize(buffer.data());
+    });
+    // Le tampon relu est identique à l'original
+    const Opt *copy = reinterpret_cast<const Opt *>(buffer.data());
+    for (long i = 0; i < n; i++) {
+        if (copy[i].isPresent() != values[i].isPresent()) {
+            std::printf("%s : copie incorrecte à l'indice %ld\n", name, i);
+            std::exit(1);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    long n = bench::iterations(argc, argv, 1000000);
+
+    growth<lib::optional<int>, int>("croissance optional<int> (trivial)", n);
+    growth<lib::optional<Boxed, lib::inline_storage<Boxed> >, Boxed>("croissance optional<Boxed>", n);
+    growth<lib::optional_stack<int>, int>("croissance optional_stack<int> (trivial)", n);
+    growth<lib::optional_stack<Boxed>, Boxed>("croissance optional_stack<Boxed>", n);
+
+    bulkCopy<lib::optional<int>, int>("copie en bloc optional<int> (memcpy)", n);
+    bulkCopy<lib::optional<Boxed, lib::inline_storage<Boxed> >, Boxed>("copie en bloc optional<Boxed>", n);
+    bulkCopy<lib::optional_stack<int>, int>("copie en bloc optional_stack<int> (memcpy)", n);
+    bulkCopy<lib::optional_stack<Boxed>, Boxed>("copie en bloc optional_stack<Boxed>", n);
+
+    return 0;
+}
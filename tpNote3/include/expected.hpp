@@ -0,0 +1,412 @@
+#ifndef EXPECTED_HPP
+#define EXPECTED_HPP
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "optional_config.hpp"
+#include "optional_storage.hpp"
+#include "optional_traits.hpp"
+
+/* lib::expected<T, E> : une valeur T, ou bien une erreur E qui explique son absence.
+ *
+ * Là où optional_stack ne dit pas pourquoi il est vide (et orElseThrow lève une exception),
+ * un expected vide porte une erreur que l'on teste et lit comme une valeur ordinaire :
+ * le chemin d'échec ne coûte qu'un branchement, il n'y a rien à dérouler.
+ * Tout fonctionne sous -fno-exceptions (seuls orElseThrow, operator* et error() mal employés
+ * terminent alors le programme, cf. raise_runtime_error).
+ *
+ * La valeur et l'erreur partagent une même union (expected_storage), avec un seul
+ * booléen qui dit laquelle est construite : sizeof(expected<T, E>) est celui du plus
+ * grand des deux, plus ce booléen. On n'utilise pas la niche : une valeur (ou une erreur)
+ * égale à la sentinelle, ex : nullptr, doit rester une valeur. Copie, déplacement et
+ * destruction sont ceux du stockage : expected est trivialement copiable, et utilisable
+ * dans une expression constante, si T et E sont trivialement copiables et destructibles.
+ */
+
+namespace lib {
+
+    // Étiquette pour construire un expected en erreur
+    struct unexpect_t {
+    };
+
+    constexpr unexpect_t unexpect = unexpect_t();
+
+    template<class T, class E>
+    class expected;
+
+    template<class T, class E>
+    struct expected_trivial : std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value
+            && std::is_trivially_copyable<E>::value && std::is_trivially_destructible<E>::value> {
+    };
+
+    /* Stockage de la valeur ou de l'erreur : une union et un booléen.
+     * Pour T et E trivialement copiables et destructibles, copie, déplacement et destruction
+     * sont ceux générés par défaut (triviaux) et tout est constexpr, comme trivial_storage.
+     * La spécialisation <T, E, false> construit et détruit le membre actif de l'union.
+     */
+    template<class T, class E, bool Trivial = expected_trivial<T, E>::value>
+    class expected_storage {
+    private:
+        union {
+            T t; // membre actif si has_value
+            E e;
+        };
+
+        bool has_value;
+
+    public:
+        template<class... Args>
+        constexpr explicit expected_storage(in_place_t, Args &&... args);
+
+        template<class... Args>
+        constexpr explicit expected_storage(unexpect_t, Args &&... args);
+
+        constexpr bool hasValue() const;
+
+        constexpr const T &value() const;
+
+        T &mutableValue();
+
+        constexpr const E &error() const;
+    };
+
+    template<class T, class E>
+    class expected_storage<T, E, false> {
+    private:
+        union {
+            T t;
+            E e;
+        };
+
+        bool has_value;
+
+        // Construit dans l'union le membre actif de other
+        template<class Other>
+        void construct_from(Other &&other);
+
+        void destroy();
+
+    public:
+        template<class... Args>
+        explicit expected_storage(in_place_t, Args &&... args);
+
+        template<class... Args>
+        explicit expected_storage(unexpect_t, Args &&... args);
+
+        expected_storage(const expected_storage<T, E, false> &other);
+
+        expected_storage<T, E, false> &operator=(const expected_storage<T, E, false> &other);
+
+        expected_storage(expected_storage<T, E, false> &&other)
+        noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_constructible<E>::value);
+
+        expected_storage<T, E, false> &operator=(expected_storage<T, E, false> &&other)
+        noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_constructible<E>::value);
+
+        ~expected_storage();
+
+        bool hasValue() const;
+
+        const T &value() const;
+
+        T &mutableValue();
+
+        const E &error() const;
+    };
+
+    template<class R>
+    struct is_expected_type : std::false_type {
+    };
+
+    template<class U, class G>
+    struct is_expected_type<expected<U, G> > : std::true_type {
+    };
+
+    /* Type retourné par map : l'expected retourné par f tel quel,
+     * ou bien un expected de la valeur retournée par f, avec la même erreur E.
+     */
+    template<class F, class T, class E>
+    struct expected_map {
+        typedef typename value_result<F, T>::type value_type;
+
+        typedef typename std::conditional<
+                is_expected_type<value_type>::value,
+                value_type,
+                expected<value_type, E>
+        >::type type;
+    };
+
+    template<class T, class E>
+    class expected {
+    private:
+        template<class U, class G>
+        friend class expected;
+
+        expected_storage<T, E> s;
+
+        template<class... Args>
+        constexpr explicit expected(in_place_t, Args &&... args);
+
+        constexpr expected(unexpect_t, const E &e);
+
+        template<class F>
+        constexpr typename expected_map<F, T, E>::type map_impl(F &&f, std::false_type) const;
+
+        template<class F>
+        constexpr typename expected_map<F, T, E>::type map_impl(F &&f, std::true_type) const;
+
+    public:
+        /* Fabriques : une valeur, ou une erreur */
+        static constexpr expected<T, E> of(const T &t);
+
+        static constexpr expected<T, E> failure(const E &e);
+
+        constexpr bool isPresent() const;
+
+        constexpr bool isEmpty() const;
+
+        constexpr explicit operator bool() const;
+
+        // L'erreur ; à n'appeler que si isEmpty()
+        constexpr const E &error() const;
+
+        constexpr T orElse(const T &other) const;
+
+        // Lève std::runtime_error si isEmpty() (termine le programme sans exceptions)
+        constexpr T orElseThrow() const &;
+
+        T orElseThrow() &&;
+
+        constexpr const T &operator*() const &;
+
+        /* Comme optional_stack::transform : f retourne une valeur U, construite dans
+         * l'expected<U, E> retourné ; si f retourne un expected<U, E>, celui-ci est
+         * retourné tel quel. Une erreur est propagée sans appeler f.
+         */
+        template<class F>
+        constexpr typename expected_map<F, T, E>::type map(F &&f) const;
+
+        // e devient l'erreur si la valeur ne satisfait pas predicate
+        template<class F>
+        constexpr expected<T, E> filter(F &&predicate, const E &e) const &;
+    };
+
+    // ======================= expected_storage =====================
+
+    template<class T, class E, bool Trivial>
+    template<class... Args>
+    constexpr expected_storage<T, E, Trivial>::expected_storage(in_place_t, Args &&... args)
+            : t(std::forward<Args>(args)...), has_value{true} {}
+
+    template<class T, class E, bool Trivial>
+    template<class... Args>
+    constexpr expected_storage<T, E, Trivial>::expected_storage(unexpect_t, Args &&... args)
+            : e(std::forward<Args>(args)...), has_value{false} {}
+
+    template<class T, class E, bool Trivial>
+    constexpr bool expected_storage<T, E, Trivial>::hasValue() const {
+        return has_value;
+    }
+
+    template<class T, class E, bool Trivial>
+    constexpr const T &expected_storage<T, E, Trivial>::value() const {
+        return t;
+    }
+
+    template<class T, class E, bool Trivial>
+    T &expected_storage<T, E, Trivial>::mutableValue() {
+        return t;
+    }
+
+    template<class T, class E, bool Trivial>
+    constexpr const E &expected_storage<T, E, Trivial>::error() const {
+        return e;
+    }
+
+    template<class T, class E>
+    template<class Other>
+    void expected_storage<T, E, false>::construct_from(Other &&other) {
+        if (other.has_value) {
+            new(&this->t) T(std::forward<Other>(other).t);
+        } else {
+            new(&this->e) E(std::forward<Other>(other).e);
+        }
+        has_value = other.has_value;
+    }
+
+    template<class T, class E>
+    void expected_storage<T, E, false>::destroy() {
+        if (has_value) {
+            t.~T();
+        } else {
+            e.~E();
+        }
+    }
+
+    template<class T, class E>
+    template<class... Args>
+    expected_storage<T, E, false>::expected_storage(in_place_t, Args &&... args)
+            : t(std::forward<Args>(args)...), has_value{true} {}
+
+    template<class T, class E>
+    template<class... Args>
+    expected_storage<T, E, false>::expected_storage(unexpect_t, Args &&... args)
+            : e(std::forward<Args>(args)...), has_value{false} {}
+
+    template<class T, class E>
+    expected_storage<T, E, false>::expected_storage(const expected_storage<T, E, false> &other) {
+        construct_from(other);
+    }
+
+    template<class T, class E>
+    expected_storage<T, E, false> &
+    expected_storage<T, E, false>::operator=(const expected_storage<T, E, false> &other) {
+        // Comme inline_storage : l'ancien membre actif est détruit avant de construire le nouveau
+        if (&other != this) {
+            destroy();
+            construct_from(other);
+        }
+        return *this;
+    }
+
+    template<class T, class E>
+    expected_storage<T, E, false>::expected_storage(expected_storage<T, E, false> &&other)
+    noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_constructible<E>::value) {
+        construct_from(std::move(other));
+    }
+
+    template<class T, class E>
+    expected_storage<T, E, false> &expected_storage<T, E, false>::operator=(expected_storage<T, E, false> &&other)
+    noexcept(std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_constructible<E>::value) {
+        if (&other != this) {
+            destroy();
+            construct_from(std::move(other));
+        }
+        return *this;
+    }
+
+    template<class T, class E>
+    expected_storage<T, E, false>::~expected_storage() {
+        destroy();
+    }
+
+    template<class T, class E>
+    bool expected_storage<T, E, false>::hasValue() const {
+        return has_value;
+    }
+
+    template<class T, class E>
+    const T &expected_storage<T, E, false>::value() const {
+        return t;
+    }
+
+    template<class T, class E>
+    T &expected_storage<T, E, false>::mutableValue() {
+        return t;
+    }
+
+    template<class T, class E>
+    const E &expected_storage<T, E, false>::error() const {
+        return e;
+    }
+
+    // =========================== expected =========================
+
+    /* Comme pour optional_stack, les fonctions constexpr sont écrites
+     * sous la forme d'un unique return (C++11).
+     */
+
+    template<class T, class E>
+    template<class... Args>
+    constexpr expected<T, E>::expected(in_place_t, Args &&... args)
+            : s{in_place, std::forward<Args>(args)...} {}
+
+    template<class T, class E>
+    constexpr expected<T, E>::expected(unexpect_t, const E &e) : s{unexpect, e} {}
+
+    template<class T, class E>
+    constexpr expected<T, E> expected<T, E>::of(const T &t) {
+        return expected<T, E>(in_place, t);
+    }
+
+    template<class T, class E>
+    constexpr expected<T, E> expected<T, E>::failure(const E &e) {
+        return expected<T, E>(unexpect, e);
+    }
+
+    template<class T, class E>
+    constexpr bool expected<T, E>::isPresent() const {
+        return s.hasValue();
+    }
+
+    template<class T, class E>
+    constexpr bool expected<T, E>::isEmpty() const {
+        return !s.hasValue();
+    }
+
+    template<class T, class E>
+    constexpr expected<T, E>::operator bool() const {
+        return isPresent();
+    }
+
+    template<class T, class E>
+    constexpr const E &expected<T, E>::error() const {
+        return isPresent() ? raise_runtime_error<const E &>("No error in a present expected") : s.error();
+    }
+
+    template<class T, class E>
+    constexpr T expected<T, E>::orElse(const T &other) const {
+        return isEmpty() ? other : s.value();
+    }
+
+    template<class T, class E>
+    constexpr T expected<T, E>::orElseThrow() const &{
+        return isEmpty() ? raise_runtime_error<T>("Cannot get value of an expected holding an error") : s.value();
+    }
+
+    template<class T, class E>
+    T expected<T, E>::orElseThrow() &&{
+        if (isEmpty()) {
+            raise_runtime_error<void>("Cannot get value of an expected holding an error");
+        }
+        return std::move(s.mutableValue());
+    }
+
+    template<class T, class E>
+    constexpr const T &expected<T, E>::operator*() const &{
+        return isEmpty() ? raise_runtime_error<const T &>("Cannot dereference an expected holding an error")
+                         : s.value();
+    }
+
+    template<class T, class E>
+    template<class F>
+    constexpr typename expected_map<F, T, E>::type expected<T, E>::map(F &&f) const {
+        return map_impl(std::forward<F>(f), is_expected_type<typename expected_map<F, T, E>::value_type>());
+    }
+
+    template<class T, class E>
+    template<class F>
+    constexpr typename expected_map<F, T, E>::type expected<T, E>::map_impl(F &&f, std::false_type) const {
+        return isEmpty()
+               ? expected_map<F, T, E>::type::failure(s.error())
+               : typename expected_map<F, T, E>::type(in_place, std::forward<F>(f)(s.value()));
+    }
+
+    template<class T, class E>
+    template<class F>
+    constexpr typename expected_map<F, T, E>::type expected<T, E>::map_impl(F &&f, std::true_type) const {
+        return isEmpty() ? expected_map<F, T, E>::type::failure(s.error()) : std::forward<F>(f)(s.value());
+    }
+
+    template<class T, class E>
+    template<class F>
+    constexpr expected<T, E> expected<T, E>::filter(F &&predicate, const E &e) const &{
+        return isEmpty() ? *this : std::forward<F>(predicate)(s.value()) ? *this : failure(e);
+    }
+
+}
+
+
+#endif
@@ -2,6 +2,8 @@
 #include <functional>
 #include <vector>
 #include <algorithm>
+#include "optional_config.hpp"
+#include "pointer_set.hpp"
 
 namespace lib {
 
@@ -10,7 +12,9 @@ namespace lib {
     private:
         T *t;
 
-        static std::vector<T *> owned_ptrs;
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        static pointer_set<T> owned_ptrs;
+#endif
 
         static bool isOwned(T *t);
 
@@ -192,27 +196,17 @@ namespace lib {
     template<class T>
     optional<T>::optional() : t{nullptr} {}
 
+    /* Transfert d'appartenance : le pointeur reste dans owned_ptrs,
+     * seule l'instance qui le possède change.
+     * t n'est pas encore initialisé dans un constructeur, il n'y a rien à libérer.
+     */
     template<class T>
-    optional<T>::optional(optional<T> &other) {
-        if (t == other.t) return;
-        if (t != nullptr) {
-            removeFromOwned(t);
-            delete t;
-        }
-        t = other.release();
-        addToOwned(t);
+    optional<T>::optional(optional<T> &other) : t{other.t} {
         other.t = nullptr;
     }
 
     template<class T>
-    optional<T>::optional(optional<T> &&other) noexcept {
-        if (t == other.t) return;
-        if (t != nullptr) {
-            removeFromOwned(t);
-            delete t;
-        }
-        t = other.release();
-        addToOwned(t);
+    optional<T>::optional(optional<T> &&other) noexcept : t{other.t} {
         other.t = nullptr;
     }
 
@@ -223,37 +217,47 @@ namespace lib {
             removeFromOwned(t);
             delete t;
         }
-        t = other.release();
-        addToOwned(t);
+        t = other.t;
         other.t = nullptr;
         return *this;
     }
 
     template<class T>
     bool optional<T>::isOwned(T *t) {
-        for (unsigned i = 0; i < owned_ptrs.size(); i++) {
-            if (owned_ptrs.at(i) == t) return true;
-        }
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        return owned_ptrs.contains(t);
+#else
+        (void) t;
         return false;
+#endif
     }
 
     template<class T>
     void optional<T>::addToOwned(T *t) {
-        owned_ptrs.push_back(t);
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        if (t != nullptr) {
+            owned_ptrs.insert(t);
+        }
+#else
+        (void) t;
+#endif
     }
 
     template<class T>
     void optional<T>::removeFromOwned(T *t) {
-        auto f = std::find(owned_ptrs.begin(), owned_ptrs.end(), t);
-        if (f != owned_ptrs.end()) {
-            owned_ptrs.erase(f);
-        }
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        owned_ptrs.erase(t);
+#else
+        (void) t;
+#endif
     }
 
 
     template<class T>
-    const optional_ptr<T> &optional<T>::none = optional_ptr<T>();
+    const optional<T> &optional<T>::none = optional<T>();
 
-    template<class T> std::vector<T *> optional<T>::owned_ptrs;
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+    template<class T> pointer_set<T> optional<T>::owned_ptrs;
+#endif
 
 }
\ No newline at end of file
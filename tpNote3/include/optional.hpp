@@ -5,35 +5,76 @@
 #include <functional>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include "optional_storage.hpp"
+#include "optional_traits.hpp"
 
 // Ceci est l'implémentation demandée dans le TP
 
 namespace lib {
 
-    template<class T>
+    template<class T, class Storage = typename default_storage<T>::type>
+    class optional;
+
+    template<class U, class S>
+    struct is_optional_type<optional<U, S> > : std::true_type {
+    };
+
+    /* Type retourné par transform : l'optionnel retourné par f tel quel,
+     * ou bien un optionnel de la valeur retournée par f, avec la même politique de stockage.
+     */
+    template<class F, class T, class Storage>
+    struct optional_transform {
+        typedef typename value_result<F, T>::type value_type;
+
+        typedef typename std::conditional<
+                is_optional_type<value_type>::value,
+                value_type,
+                optional<value_type, typename Storage::template rebind<value_type> >
+        >::type type;
+    };
+
+    /* Storage est la politique de stockage de la valeur (cf. optional_storage.hpp) :
+     * par défaut les petits types trivialement copiables sont stockés dans l'instance
+     * elle-même (inline_storage), les autres derrière un pointeur sur le tas (heap_storage).
+     */
+    template<class T, class Storage>
     class optional {
     private:
-        T *t;
+        template<class U, class S>
+        friend class optional;
+
+        Storage s;
 
         // Constructeur pour l'optional non vide
         // Privé car l'on ne souhaite pas construire d'optionnel directement,
-        explicit optional(T *t);
+        explicit optional(const T &t);
+
+        // Construit la valeur directement dans le stockage à partir de args
+        template<class... Args>
+        explicit optional(in_place_t, Args &&... args);
+
+        // Constructeur pour l'optional vide, privé donc
+        explicit optional();
+
+        // Adopte un stockage déjà construit (fabriques avec allocateur)
+        explicit optional(Storage &&s);
 
         // Référence statique vers l'optional vide
-        const static optional<T> &none;
+        const static optional<T, Storage> &none;
+
+        template<class F>
+        typename optional_transform<F, T, Storage>::type transform_impl(F &&f, std::false_type) const;
+
+        template<class F>
+        typename optional_transform<F, T, Storage>::type transform_impl(F &&f, std::true_type) const;
 
     public:
-        /* On souhaite l'un des opérateurs suivants donc tous ("Rule of three") :
-         * - un destructeur
-         * - un constructeur par copie
-         * - un opérateur d'affectation
+        /* Le destructeur, la construction et l'affectation par copie et par déplacement
+         * ("Rule of five") sont délégués à la politique de stockage : ceux générés
+         * par défaut suffisent, et le déplacement est noexcept dès que celui de T l'est.
          * cf. fonction main pour plus d'explications sur ce choix
          */
-        ~optional();
-
-        optional(const optional<T> &other);
-
-        optional<T> &operator=(const optional<T> &other);
 
         /* Surcharge de l'opérateur bool() pour convertir l'optional_stack
          * en une valeur de vérité.
@@ -42,28 +83,53 @@ namespace lib {
         explicit operator bool() const;
 
         /* Fabriques de valeurs optionnelles */
-        static optional<T> of(T &t);
+        static optional<T, Storage> of(T &t);
 
-        static optional<T> ofNullable(T *t);
+        static optional<T, Storage> ofNullable(T *t);
 
         /* Retourne une référence vers l'optional empty */
-        static const optional<T> &empty();
+        static const optional<T, Storage> &empty();
+
+        /* Fabriques avec allocateur, pour les politiques de stockage qui en acceptent un
+         * (allocator_storage, cf. optional_allocator.hpp) : la valeur est allouée par alloc,
+         * et l'optional garde alloc pour ses copies et affectations.
+         */
+        template<class Alloc>
+        static optional<T, Storage> of(T &t, const Alloc &alloc);
+
+        template<class Alloc>
+        static optional<T, Storage> ofNullable(T *t, const Alloc &alloc);
+
+        template<class Alloc>
+        static optional<T, Storage> empty(const Alloc &alloc);
 
         bool isEmpty() const;
 
         bool isPresent() const;
 
-        T orElseThrow() const;
+        /* Sur un optional temporaire (ou std::move(o)), orElseThrow et *
+         * déplacent la valeur au lieu de la copier.
+         */
+        T orElseThrow() const &;
+
+        T orElseThrow() &&;
 
         T orElse(T &other) const;
 
         /*
          * Implémentation des opérateurs sur pointeurs
          */
-        const T &operator*();
+        const T &operator*() const &;
+
+        T operator*() &&;
 
         const T *operator->();
 
+        /* Accès en écriture à la valeur, lève une exception si l'optional est vide.
+         * Avec cow_storage (cf. optional_cow.hpp), une valeur partagée est d'abord clonée.
+         */
+        T &mutableValue();
+
         /* On propose deux versions de map et filter :
          * - l'une prend en argument un pointeur vers une fonction (comme en C)
          * - l'autre, plus idiomatique en C++ moderne (>= C++11), prend en argument
@@ -83,15 +149,41 @@ namespace lib {
         template<class U>
         optional<U> map(U *(&f)(T));
 
-        optional<T> filter(std::function<bool(T)> predicate);
+        optional<T, Storage> filter(std::function<bool(T)> predicate) const;
+
+        optional<T, Storage> filter(bool (&predicate)(T)) const;
 
-        optional<T> filter(bool (&predicate)(T));
+        /* Versions génériques de map et filter : f peut être n'importe quel appelable
+         * (lambda avec ou sans capture, foncteur, pointeur de fonction).
+         * Contrairement à std::function il n'y a ni effacement de type ni allocation,
+         * l'appel peut donc être inliné. La valeur est passée par référence constante.
+         */
+        template<class F>
+        optional<typename pointee_result<F, T>::type> map(F &&f);
+
+        template<class F>
+        optional<T, Storage> filter(F &&predicate) const &;
+
+        // Sur un optional temporaire, filter retourne *this déplacé au lieu d'une copie
+        template<class F>
+        optional<T, Storage> filter(F &&predicate) &&;
+
+        /* Comme map, mais f retourne directement une valeur U (et non plus un U* alloué) :
+         * la valeur est construite dans le stockage de l'optional retourné, qui garde
+         * la même politique de stockage. Aucune allocation avec inline_storage.
+         * Si f retourne un lib::optional<U>, celui-ci est retourné tel quel ("flat map").
+         */
+        template<class F>
+        typename optional_transform<F, T, Storage>::type transform(F &&f) const;
     };
 
-    template<class T>
+    template<class T, class Storage>
     template<class U>
-    optional<U> optional<T>::map(std::function<U *(T)> f) {
-        U *u = f(*t);
+    optional<U> optional<T, Storage>::map(std::function<U *(T)> f) {
+        if (isEmpty()) {
+            return optional<U>::empty();
+        }
+        U *u = f(*s.get());
         optional<U> o = optional<U>::ofNullable(u);
         if (u != nullptr) {
             delete u;
@@ -99,10 +191,13 @@ namespace lib {
         return o;
     }
 
-    template<class T>
+    template<class T, class Storage>
     template<class U>
-    optional<U> optional<T>::map(U *(&f)(T)) {
-        U *u = f(*t);
+    optional<U> optional<T, Storage>::map(U *(&f)(T)) {
+        if (isEmpty()) {
+            return optional<U>::empty();
+        }
+        U *u = f(*s.get());
         optional<U> o = optional<U>::ofNullable(u);
         if (u != nullptr) {
             delete u;
@@ -110,128 +205,416 @@ namespace lib {
         return o;
     }
 
-    template<class T>
-    optional<T>
-    optional<T>::filter(std::function<bool(T)> predicate) {
+    template<class T, class Storage>
+    optional<T, Storage>
+    optional<T, Storage>::filter(std::function<bool(T)> predicate) const {
         if (isEmpty()) {
-            return optional<T>::empty();
+            return optional<T, Storage>::empty();
         }
-        if (predicate(*t)) {
+        if (predicate(*s.get())) {
             return *this;
         }
-        return optional<T>::empty();
+        return optional<T, Storage>::empty();
     }
 
-    template<class T>
-    optional<T>
-    optional<T>::filter(bool(&predicate)(T)) {
+    template<class T, class Storage>
+    optional<T, Storage>
+    optional<T, Storage>::filter(bool(&predicate)(T)) const {
         if (isEmpty()) {
-            return optional<T>::empty();
+            return optional<T, Storage>::empty();
         }
-        if (predicate(*t)) {
+        if (predicate(*s.get())) {
             return *this;
         }
-        return optional<T>::empty();
+        return optional<T, Storage>::empty();
     }
 
-    template<class T>
-    optional<T>::operator bool() const {
+    template<class T, class Storage>
+    template<class F>
+    optional<typename pointee_result<F, T>::type> optional<T, Storage>::map(F &&f) {
+        typedef typename pointee_result<F, T>::type U;
+        if (isEmpty()) {
+            return optional<U>::empty();
+        }
+        U *u = std::forward<F>(f)(*s.get());
+        optional<U> o = optional<U>::ofNullable(u);
+        if (u != nullptr) {
+            delete u;
+        }
+        return o;
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    optional<T, Storage> optional<T, Storage>::filter(F &&predicate) const &{
+        if (isEmpty() || !std::forward<F>(predicate)(*s.get())) {
+            return optional<T, Storage>::empty();
+        }
+        return *this;
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    optional<T, Storage> optional<T, Storage>::filter(F &&predicate) &&{
+        if (isEmpty() || !std::forward<F>(predicate)(*s.get())) {
+            return optional<T, Storage>::empty();
+        }
+        return std::move(*this);
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    typename optional_transform<F, T, Storage>::type optional<T, Storage>::transform(F &&f) const {
+        typedef typename optional_transform<F, T, Storage>::value_type R;
+        return transform_impl(std::forward<F>(f), is_optional_type<R>());
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    typename optional_transform<F, T, Storage>::type
+    optional<T, Storage>::transform_impl(F &&f, std::false_type) const {
+        typedef typename optional_transform<F, T, Storage>::type R;
+        if (isEmpty()) {
+            return R::empty();
+        }
+        return R(in_place, std::forward<F>(f)(*s.get()));
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    typename optional_transform<F, T, Storage>::type
+    optional<T, Storage>::transform_impl(F &&f, std::true_type) const {
+        typedef typename optional_transform<F, T, Storage>::type R;
+        if (isEmpty()) {
+            return R::empty();
+        }
+        return std::forward<F>(f)(*s.get());
+    }
+
+    template<class T, class Storage>
+    optional<T, Storage>::operator bool() const {
         return isPresent();
     }
 
-    template<class T>
-    T optional<T>::orElse(T &other) const {
+    template<class T, class Storage>
+    T optional<T, Storage>::orElse(T &other) const {
         if (isEmpty()) {
             return other;
         }
-        return *t;
+        return *s.get();
     }
 
-    template<class T>
-    T optional<T>::orElseThrow() const {
+    template<class T, class Storage>
+    T optional<T, Storage>::orElseThrow() const &{
         if (isEmpty()) {
             throw std::runtime_error("Cannot get value of None type");
         }
-        return *t;
+        return *s.get();
     }
 
-    template<class T>
-    bool optional<T>::isEmpty() const {
-        return t == nullptr;
+    template<class T, class Storage>
+    T optional<T, Storage>::orElseThrow() &&{
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot get value of None type");
+        }
+        return std::move(*s.getMutable());
     }
 
-    template<class T>
-    optional<T>::~optional() {
-        if (t != nullptr) {
-            delete t;
-        }
+    template<class T, class Storage>
+    bool optional<T, Storage>::isEmpty() const {
+        return s.isEmpty();
     }
 
-    template<class T>
-    optional<T> optional<T>::of(T &t) {
-        return optional<T>(new T(t));
+    template<class T, class Storage>
+    optional<T, Storage> optional<T, Storage>::of(T &t) {
+        return optional<T, Storage>(t);
     }
 
-    template<class T>
-    const optional<T> &optional<T>::empty() {
+    template<class T, class Storage>
+    const optional<T, Storage> &optional<T, Storage>::empty() {
         return none;
     }
 
-    template<class T>
-    optional<T> optional<T>::ofNullable(T *t) {
+    template<class T, class Storage>
+    template<class Alloc>
+    optional<T, Storage> optional<T, Storage>::of(T &t, const Alloc &alloc) {
+        return optional<T, Storage>(Storage(std::allocator_arg, alloc, in_place, t));
+    }
+
+    template<class T, class Storage>
+    template<class Alloc>
+    optional<T, Storage> optional<T, Storage>::ofNullable(T *t, const Alloc &alloc) {
         if (t == nullptr) {
-            return optional<T>::empty();
+            return optional<T, Storage>::empty(alloc);
         }
-        return optional<T>(new T(*t));
+        return optional<T, Storage>::of(*t, alloc);
+    }
+
+    template<class T, class Storage>
+    template<class Alloc>
+    optional<T, Storage> optional<T, Storage>::empty(const Alloc &alloc) {
+        return optional<T, Storage>(Storage(std::allocator_arg, alloc));
     }
 
-    template<class T>
-    bool optional<T>::isPresent() const {
+    template<class T, class Storage>
+    optional<T, Storage> optional<T, Storage>::ofNullable(T *t) {
+        if (t == nullptr) {
+            return optional<T, Storage>::empty();
+        }
+        return optional<T, Storage>(*t);
+    }
+
+    template<class T, class Storage>
+    bool optional<T, Storage>::isPresent() const {
         return !isEmpty();
     }
 
-    template<class T>
-    const T &optional<T>::operator*() {
-        return t == nullptr ? throw std::runtime_error("Cannot dereference nullptr") : *t;
+    template<class T, class Storage>
+    const T &optional<T, Storage>::operator*() const &{
+        return isEmpty() ? throw std::runtime_error("Cannot dereference nullptr") : *s.get();
+    }
+
+    template<class T, class Storage>
+    T optional<T, Storage>::operator*() &&{
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot dereference nullptr");
+        }
+        return std::move(*s.getMutable());
+    }
+
+    template<class T, class Storage>
+    T &optional<T, Storage>::mutableValue() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot get value of None type");
+        }
+        return *s.getMutable();
     }
 
-    template<class T>
-    const T *optional<T>::operator->() {
-        return t;
+    template<class T, class Storage>
+    const T *optional<T, Storage>::operator->() {
+        return s.get();
     }
 
-    template<class T>
-    optional<T>::optional(T *t) : t{t} {}
+    template<class T, class Storage>
+    optional<T, Storage>::optional(const T &t) : s{in_place, t} {}
+
+    template<class T, class Storage>
+    template<class... Args>
+    optional<T, Storage>::optional(in_place_t, Args &&... args) : s{in_place, std::forward<Args>(args)...} {}
+
+    template<class T, class Storage>
+    optional<T, Storage>::optional() : s{} {}
+
+    template<class T, class Storage>
+    optional<T, Storage>::optional(Storage &&s) : s{std::move(s)} {}
+
+    template<class T, class Storage>
+    const optional<T, Storage> &optional<T, Storage>::none = optional<T, Storage>();
+
+    // ==================== optional<T &> (référence) ===================
+
+    /* Type retourné par transform sur un optional<T &> : f reçoit un T &.
+     * Si f retourne une référence U &, le résultat est un optional<U &> (toujours sans copie),
+     * sinon un optional de la valeur retournée, ou l'optionnel retourné par f tel quel.
+     */
+    template<class F, class T>
+    struct optional_ref_transform {
+        typedef typename std::result_of<F(T &)>::type result;
+
+        typedef typename std::decay<result>::type value_type;
+
+        typedef typename std::conditional<
+                is_optional_type<value_type>::value,
+                value_type,
+                typename std::conditional<
+                        std::is_lvalue_reference<result>::value,
+                        optional<result>,
+                        optional<value_type>
+                >::type
+        >::type type;
+    };
 
-    template<class T>
-    optional<T>::optional(const optional<T> &other)
-    /* On ne déréférence pas un pointeur nul! Et l'on copie l'objet pointé par other.t
-     * afin de ne pas se retrouver avec deux pointeurs pointant vers le même objet
-     * et obtenir un double free lorsque le destructeur de this et other est appelé.
+    /* Optionnel de référence : un simple pointeur (cf. reference_storage), pour retourner
+     * le résultat d'une recherche dans un conteneur sans copier la valeur.
+     * orElse, orElseThrow, * et -> retournent des références sur l'objet référencé,
+     * map/filter/transform le passent par référence aux fonctions.
+     *
+     * La copie et l'affectation recopient le pointeur : l'affectation "re-lie" l'optional
+     * à un autre objet, elle ne modifie jamais l'objet référencé.
+     * Comme pour une référence, l'objet doit survivre à l'optional.
      */
-            : t{other.t == nullptr ? nullptr : new T(*other.t)} {}
-
-    template<class T>
-    optional<T> &optional<T>::operator=(const optional<T> &other) {
-        if (&other != this) {
-            /* On supprime l'objet uniquement pointé par t avant de le faire pointer
-             * vers autre chose pour éviter une fuite de mémoire.
-             */
-            if (t != nullptr) {
-                delete t;
-            }
-            // Copie ou non de l'objet pointé par le pointeur de l'autre instance other.
-            if (other.t != nullptr) {
-                t = new T(*other.t);
-            } else {
-                t = nullptr;
-            }
+    template<class T, class Storage>
+    class optional<T &, Storage> {
+    private:
+        template<class U, class S>
+        friend class optional;
+
+        Storage s;
+
+        optional(in_place_t, T &t);
+
+        explicit optional();
+
+        template<class F>
+        typename optional_ref_transform<F, T>::type transform_impl(F &&f, std::false_type) const;
+
+        template<class F>
+        typename optional_ref_transform<F, T>::type transform_impl(F &&f, std::true_type) const;
+
+    public:
+        explicit operator bool() const;
+
+        static optional<T &, Storage> of(T &t);
+
+        static optional<T &, Storage> ofNullable(T *t);
+
+        // Par valeur : un optional<T &> vide n'est qu'un pointeur nul
+        static optional<T &, Storage> empty();
+
+        bool isEmpty() const;
+
+        bool isPresent() const;
+
+        T &orElseThrow() const;
+
+        // other doit survivre à la référence retournée (pas de temporaire)
+        T &orElse(T &other) const;
+
+        T &operator*() const;
+
+        T *operator->() const;
+
+        /* Attention : contrairement à optional<T>::map, le pointeur U* retourné par f(T &)
+         * n'est jamais supprimé, le résultat est un optional<U &> qui ne le possède pas.
+         * f doit donc retourner un pointeur non possédant (vers un membre de l'objet
+         * référencé, ou un objet qui survit au résultat) ou nullptr : un f écrit pour
+         * optional<T>::map, qui retourne un pointeur alloué par new, fuit ici.
+         * Pour calculer une nouvelle valeur, utiliser transform.
+         */
+        template<class F>
+        optional<typename pointee_result<F, T &>::type &> map(F &&f) const;
+
+        template<class F>
+        optional<T &, Storage> filter(F &&predicate) const;
+
+        template<class F>
+        typename optional_ref_transform<F, T>::type transform(F &&f) const;
+    };
+
+    template<class T, class Storage>
+    optional<T &, Storage>::optional(in_place_t, T &t) : s{in_place, t} {}
+
+    template<class T, class Storage>
+    optional<T &, Storage>::optional() : s{} {}
+
+    template<class T, class Storage>
+    optional<T &, Storage>::operator bool() const {
+        return isPresent();
+    }
+
+    template<class T, class Storage>
+    optional<T &, Storage> optional<T &, Storage>::of(T &t) {
+        return optional<T &, Storage>(in_place, t);
+    }
+
+    template<class T, class Storage>
+    optional<T &, Storage> optional<T &, Storage>::ofNullable(T *t) {
+        if (t == nullptr) {
+            return optional<T &, Storage>();
+        }
+        return optional<T &, Storage>(in_place, *t);
+    }
+
+    template<class T, class Storage>
+    optional<T &, Storage> optional<T &, Storage>::empty() {
+        return optional<T &, Storage>();
+    }
+
+    template<class T, class Storage>
+    bool optional<T &, Storage>::isEmpty() const {
+        return s.isEmpty();
+    }
+
+    template<class T, class Storage>
+    bool optional<T &, Storage>::isPresent() const {
+        return !isEmpty();
+    }
+
+    template<class T, class Storage>
+    T &optional<T &, Storage>::orElseThrow() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot get value of None type");
+        }
+        return *s.get();
+    }
+
+    template<class T, class Storage>
+    T &optional<T &, Storage>::orElse(T &other) const {
+        return isEmpty() ? other : *s.get();
+    }
+
+    template<class T, class Storage>
+    T &optional<T &, Storage>::operator*() const {
+        return isEmpty() ? throw std::runtime_error("Cannot dereference nullptr") : *s.get();
+    }
+
+    template<class T, class Storage>
+    T *optional<T &, Storage>::operator->() const {
+        return s.get();
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    optional<typename pointee_result<F, T &>::type &> optional<T &, Storage>::map(F &&f) const {
+        typedef typename pointee_result<F, T &>::type U;
+        if (isEmpty()) {
+            return optional<U &>::empty();
+        }
+        // Pointeur non possédant : pas de delete, cf. la déclaration
+        return optional<U &>::ofNullable(std::forward<F>(f)(*s.get()));
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    optional<T &, Storage> optional<T &, Storage>::filter(F &&predicate) const {
+        if (isEmpty() || !std::forward<F>(predicate)(*s.get())) {
+            return optional<T &, Storage>();
         }
         return *this;
     }
 
-    template<class T>
-    const optional<T> &optional<T>::none = optional<T>(nullptr);
+    template<class T, class Storage>
+    template<class F>
+    typename optional_ref_transform<F, T>::type optional<T &, Storage>::transform(F &&f) const {
+        typedef typename optional_ref_transform<F, T>::value_type R;
+        return transform_impl(std::forward<F>(f), is_optional_type<R>());
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    typename optional_ref_transform<F, T>::type
+    optional<T &, Storage>::transform_impl(F &&f, std::false_type) const {
+        typedef typename optional_ref_transform<F, T>::type R;
+        if (isEmpty()) {
+            return R::empty();
+        }
+        return R(in_place, std::forward<F>(f)(*s.get()));
+    }
+
+    template<class T, class Storage>
+    template<class F>
+    typename optional_ref_transform<F, T>::type
+    optional<T &, Storage>::transform_impl(F &&f, std::true_type) const {
+        typedef typename optional_ref_transform<F, T>::type R;
+        if (isEmpty()) {
+            return R::empty();
+        }
+        return std::forward<F>(f)(*s.get());
+    }
+
+    // Rule of zero : un optional est trivialement copiable dès que son stockage l'est
+    static_assert(std::is_trivially_copyable<optional<int> >::value, "optional<int> trivialement copiable");
+    static_assert(std::is_trivially_copyable<optional<int &> >::value, "optional<int &> trivialement copiable");
 
 }
 
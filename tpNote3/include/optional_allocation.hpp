@@ -0,0 +1,206 @@
+#ifndef OPTIONAL_ALLOCATION_HPP
+#define OPTIONAL_ALLOCATION_HPP
+
+#include <cstddef>
+#include <new>
+
+/* Politiques d'allocation de heap_storage (cf. optional_storage.hpp).
+ *
+ * Une politique d'allocation Allocation<T> fournit la mémoire brute d'un T :
+ * - static void *allocate() : un emplacement de sizeof(T) octets, aligné pour T
+ * - static void deallocate(void *p) : rend un emplacement obtenu par allocate
+ * La construction et la destruction de la valeur restent à la charge de heap_storage.
+ *
+ * - new_allocation : l'allocateur global (operator new / operator delete)
+ * - pool_allocation : une liste d'emplacements libres par thread et par classe de taille,
+ *   qui recycle les emplacements libérés au lieu de les rendre à l'allocateur global
+ *
+ * La politique se choisit par instanciation, ex : optional<T, heap_storage<T, pool_allocation> >.
+ */
+
+namespace lib {
+
+    template<class T>
+    struct new_allocation {
+        static void *allocate();
+
+        static void deallocate(void *p);
+    };
+
+    // Compteurs du thread courant pour une classe de taille
+    struct pool_stats {
+        std::size_t hits;   // allocations servies par la liste d'emplacements libres
+        std::size_t misses; // allocations transmises à operator new
+        std::size_t cached; // emplacements actuellement dans la liste
+    };
+
+    /* Liste d'emplacements libres ("freelist") de Size octets, propre à chaque thread :
+     * aucune synchronisation. Un emplacement libéré par un autre thread que celui qui
+     * l'a alloué rejoint simplement la liste du thread qui le libère.
+     *
+     * Au plus max_cached emplacements sont conservés par thread, au-delà ils sont rendus
+     * à operator delete ; à la fin du thread, toute la liste est rendue, que le thread
+     * ait alloué des emplacements ou seulement libéré ceux d'un autre thread.
+     */
+    template<std::size_t Size>
+    class size_class_pool {
+    private:
+        struct node {
+            node *next;
+        };
+
+        /* Trivialement destructible : reste utilisable pendant la destruction des objets
+         * statiques et thread_local (un optional global libéré après la purge de la liste
+         * est rendu directement à operator delete).
+         */
+        struct state {
+            node *head;
+            std::size_t cached;
+            std::size_t hits;
+            std::size_t misses;
+            bool closed;
+        };
+
+        // Purge la liste à la fin du thread
+        struct drain {
+            ~drain();
+        };
+
+        static state &local();
+
+        /* Enregistre la purge de fin de thread : au premier défaut d'allocation, et au premier
+         * emplacement rangé dans une liste vide (un thread qui ne fait que libérer des
+         * emplacements alloués par un autre doit aussi rendre sa liste)
+         */
+        static void register_drain();
+
+    public:
+        static const std::size_t max_cached = 4096;
+
+        static void *allocate();
+
+        static void deallocate(void *p);
+
+        // Compteurs du thread courant pour cette classe de taille
+        static pool_stats stats();
+    };
+
+    /* Les emplacements sont regroupés par classe de taille (multiples de 16 octets) :
+     * des types de tailles voisines partagent la même liste.
+     */
+    template<class T>
+    struct pool_allocation {
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "pool_allocation : alignement de T supérieur à celui garanti par operator new");
+
+        static const std::size_t slot_size = (sizeof(T) + 15) / 16 * 16;
+
+        typedef size_class_pool<slot_size> pool;
+
+        static void *allocate();
+
+        static void deallocate(void *p);
+
+        /* Compteurs de la classe de taille slot_size, et non de T seul : ils incluent
+         * les allocations de tous les types de la même classe (ex : 24 et 32 octets)
+         */
+        static pool_stats stats();
+    };
+
+    // ======================== new_allocation ======================
+
+    template<class T>
+    void *new_allocation<T>::allocate() {
+        return ::operator new(sizeof(T));
+    }
+
+    template<class T>
+    void new_allocation<T>::deallocate(void *p) {
+        ::operator delete(p);
+    }
+
+    // ======================= size_class_pool ======================
+
+    template<std::size_t Size>
+    typename size_class_pool<Size>::state &size_class_pool<Size>::local() {
+        // Initialisé à zéro, sans destructeur : pas de garde d'initialisation à chaque accès
+        static thread_local state s;
+        return s;
+    }
+
+    template<std::size_t Size>
+    size_class_pool<Size>::drain::~drain() {
+        state &s = local();
+        while (s.head != nullptr) {
+            node *n = s.head;
+            s.head = n->next;
+            ::operator delete(n);
+        }
+        s.cached = 0;
+        s.closed = true;
+    }
+
+    template<std::size_t Size>
+    void size_class_pool<Size>::register_drain() {
+        static thread_local drain d;
+        (void) d;
+    }
+
+    template<std::size_t Size>
+    void *size_class_pool<Size>::allocate() {
+        state &s = local();
+        if (s.head != nullptr) {
+            node *n = s.head;
+            s.head = n->next;
+            s.cached--;
+            s.hits++;
+            return n;
+        }
+        s.misses++;
+        register_drain();
+        return ::operator new(Size);
+    }
+
+    template<std::size_t Size>
+    void size_class_pool<Size>::deallocate(void *p) {
+        state &s = local();
+        if (s.closed || s.cached >= max_cached) {
+            ::operator delete(p);
+            return;
+        }
+        if (s.head == nullptr) {
+            register_drain();
+        }
+        node *n = static_cast<node *>(p);
+        n->next = s.head;
+        s.head = n;
+        s.cached++;
+    }
+
+    template<std::size_t Size>
+    pool_stats size_class_pool<Size>::stats() {
+        const state &s = local();
+        return pool_stats{s.hits, s.misses, s.cached};
+    }
+
+    // ======================= pool_allocation ======================
+
+    template<class T>
+    void *pool_allocation<T>::allocate() {
+        return pool::allocate();
+    }
+
+    template<class T>
+    void pool_allocation<T>::deallocate(void *p) {
+        pool::deallocate(p);
+    }
+
+    template<class T>
+    pool_stats pool_allocation<T>::stats() {
+        return pool::stats();
+    }
+
+}
+
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef OPTIONAL_ALLOCATOR_HPP
+#define OPTIONAL_ALLOCATOR_HPP
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "optional.hpp"
+#include "optional_config.hpp"
+
+/* Politique de stockage "allocator-aware" : la valeur est sur le tas comme avec
+ * heap_storage, mais allouée, construite, détruite et libérée via un allocateur standard
+ * (std::allocator_traits), ex : std::pmr::polymorphic_allocator pour passer par un
+ * std::pmr::memory_resource (pool, monotonic buffer...).
+ *
+ *   lib::basic_optional<T, Alloc> = lib::optional<T, allocator_storage<T, Alloc> >
+ *
+ * L'allocateur se propage comme dans les conteneurs standards :
+ * - construction par copie : select_on_container_copy_construction
+ * - affectation par copie / par déplacement : selon propagate_on_container_copy_assignment
+ *   et propagate_on_container_move_assignment ; sans propagation, l'optional garde
+ *   son allocateur et, s'il diffère de celui de other, la valeur est copiée (resp. déplacée)
+ *   dans une nouvelle allocation
+ * - construction par déplacement : l'allocateur est déplacé avec la valeur
+ * Les optionals retournés par transform/map, eux, sont construits avec un allocateur
+ * par défaut (comme un nouveau conteneur).
+ */
+
+namespace lib {
+
+    template<class T, class Alloc = std::allocator<T> >
+    class allocator_storage {
+    private:
+        typedef std::allocator_traits<Alloc> traits;
+
+        static_assert(std::is_same<typename traits::value_type, T>::value,
+                      "allocator_storage : l'allocateur doit allouer des T");
+        static_assert(std::is_same<typename traits::pointer, T *>::value,
+                      "allocator_storage : les pointeurs \"fancy\" ne sont pas pris en charge");
+
+        // L'allocateur est une base vide le plus souvent (std::allocator) : EBO
+        struct holder : Alloc {
+            T *t;
+
+            holder(const Alloc &a, T *t);
+
+            holder(Alloc &&a, T *t);
+        };
+
+        holder h;
+
+        Alloc &allocator();
+
+        const Alloc &allocator() const;
+
+        template<class... Args>
+        T *create(Args &&... args);
+
+        // Détruit et libère la valeur éventuelle, le stockage devient vide
+        void reset();
+
+        /* Propagation de l'allocateur selon propagate_on_container_*_assignment.
+         * Par surcharge et non par un simple if : certains allocateurs
+         * (std::pmr::polymorphic_allocator) ne sont pas affectables.
+         */
+        void copy_allocator(const allocator_storage<T, Alloc> &other, std::true_type);
+
+        void copy_allocator(const allocator_storage<T, Alloc> &other, std::false_type);
+
+        void move_allocator(allocator_storage<T, Alloc> &other, std::true_type);
+
+        void move_allocator(allocator_storage<T, Alloc> &other, std::false_type);
+
+    public:
+        typedef Alloc allocator_type;
+
+        template<class U>
+        using rebind = allocator_storage<U, typename traits::template rebind_alloc<U> >;
+
+        allocator_storage();
+
+        explicit allocator_storage(std::allocator_arg_t, const Alloc &a);
+
+        template<class... Args>
+        explicit allocator_storage(in_place_t, Args &&... args);
+
+        template<class... Args>
+        allocator_storage(std::allocator_arg_t, const Alloc &a, in_place_t, Args &&... args);
+
+        allocator_storage(const allocator_storage<T, Alloc> &other);
+
+        allocator_storage<T, Alloc> &operator=(const allocator_storage<T, Alloc> &other);
+
+        allocator_storage(allocator_storage<T, Alloc> &&other) noexcept;
+
+        allocator_storage<T, Alloc> &operator=(allocator_storage<T, Alloc> &&other)
+        noexcept(traits::propagate_on_container_move_assignment::value);
+
+        ~allocator_storage();
+
+        allocator_type get_allocator() const;
+
+        bool isEmpty() const;
+
+        const T *get() const;
+
+        T *getMutable();
+    };
+
+    template<class T, class Alloc = std::allocator<T> >
+    using basic_optional = optional<T, allocator_storage<T, Alloc> >;
+
+    // ====================== allocator_storage =====================
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::holder::holder(const Alloc &a, T *t) : Alloc(a), t{t} {}
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::holder::holder(Alloc &&a, T *t) : Alloc(std::move(a)), t{t} {}
+
+    template<class T, class Alloc>
+    Alloc &allocator_storage<T, Alloc>::allocator() {
+        return h;
+    }
+
+    template<class T, class Alloc>
+    const Alloc &allocator_storage<T, Alloc>::allocator() const {
+        return h;
+    }
+
+    template<class T, class Alloc>
+    template<class... Args>
+    T *allocator_storage<T, Alloc>::create(Args &&... args) {
+        T *p = traits::allocate(allocator(), 1);
+#if LIB_OPTIONAL_EXCEPTIONS
+        try {
+            traits::construct(allocator(), p, std::forward<Args>(args)...);
+        } catch (...) {
+            traits::deallocate(allocator(), p, 1);
+            throw;
+        }
+#else
+        traits::construct(allocator(), p, std::forward<Args>(args)...);
+#endif
+        return p;
+    }
+
+    template<class T, class Alloc>
+    void allocator_storage<T, Alloc>::reset() {
+        if (h.t != nullptr) {
+            traits::destroy(allocator(), h.t);
+            traits::deallocate(allocator(), h.t, 1);
+            h.t = nullptr;
+        }
+    }
+
+    template<class T, class Alloc>
+    void allocator_storage<T, Alloc>::copy_allocator(const allocator_storage<T, Alloc> &other, std::true_type) {
+        allocator() = other.allocator();
+    }
+
+    template<class T, class Alloc>
+    void allocator_storage<T, Alloc>::copy_allocator(const allocator_storage<T, Alloc> &, std::false_type) {}
+
+    template<class T, class Alloc>
+    void allocator_storage<T, Alloc>::move_allocator(allocator_storage<T, Alloc> &other, std::true_type) {
+        allocator() = std::move(other.allocator());
+    }
+
+    template<class T, class Alloc>
+    void allocator_storage<T, Alloc>::move_allocator(allocator_storage<T, Alloc> &, std::false_type) {}
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::allocator_storage() : h{Alloc(), nullptr} {}
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::allocator_storage(std::allocator_arg_t, const Alloc &a) : h{a, nullptr} {}
+
+    template<class T, class Alloc>
+    template<class... Args>
+    allocator_storage<T, Alloc>::allocator_storage(in_place_t, Args &&... args) : h{Alloc(), nullptr} {
+        h.t = create(std::forward<Args>(args)...);
+    }
+
+    template<class T, class Alloc>
+    template<class... Args>
+    allocator_storage<T, Alloc>::allocator_storage(std::allocator_arg_t, const Alloc &a, in_place_t, Args &&... args)
+            : h{a, nullptr} {
+        h.t = create(std::forward<Args>(args)...);
+    }
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::allocator_storage(const allocator_storage<T, Alloc> &other)
+            : h{traits::select_on_container_copy_construction(other.allocator()), nullptr} {
+        if (other.h.t != nullptr) {
+            h.t = create(*other.h.t);
+        }
+    }
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc> &allocator_storage<T, Alloc>::operator=(const allocator_storage<T, Alloc> &other) {
+        if (&other != this) {
+            // L'ancienne valeur est libérée par l'allocateur qui l'a allouée
+            reset();
+            copy_allocator(other, typename traits::propagate_on_container_copy_assignment());
+            if (other.h.t != nullptr) {
+                h.t = create(*other.h.t);
+            }
+        }
+        return *this;
+    }
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::allocator_storage(allocator_storage<T, Alloc> &&other) noexcept
+            : h{std::move(other.allocator()), other.h.t} {
+        other.h.t = nullptr;
+    }
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc> &allocator_storage<T, Alloc>::operator=(allocator_storage<T, Alloc> &&other)
+    noexcept(traits::propagate_on_container_move_assignment::value) {
+        if (&other != this) {
+            reset();
+            move_allocator(other, typename traits::propagate_on_container_move_assignment());
+            if (traits::propagate_on_container_move_assignment::value || allocator() == other.allocator()) {
+                // Même allocateur : on transfère simplement le pointeur
+                h.t = other.h.t;
+                other.h.t = nullptr;
+            } else if (other.h.t != nullptr) {
+                // Allocateurs différents : la valeur est déplacée dans une allocation de this
+                h.t = create(std::move(*other.h.t));
+            }
+        }
+        return *this;
+    }
+
+    template<class T, class Alloc>
+    allocator_storage<T, Alloc>::~allocator_storage() {
+        reset();
+    }
+
+    template<class T, class Alloc>
+    typename allocator_storage<T, Alloc>::allocator_type allocator_storage<T, Alloc>::get_allocator() const {
+        return allocator();
+    }
+
+    template<class T, class Alloc>
+    bool allocator_storage<T, Alloc>::isEmpty() const {
+        return h.t == nullptr;
+    }
+
+    template<class T, class Alloc>
+    const T *allocator_storage<T, Alloc>::get() const {
+        return h.t;
+    }
+
+    template<class T, class Alloc>
+    T *allocator_storage<T, Alloc>::getMutable() {
+        return h.t;
+    }
+
+}
+
+
+#endif
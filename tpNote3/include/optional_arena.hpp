@@ -0,0 +1,328 @@
+#ifndef OPTIONAL_ARENA_HPP
+#define OPTIONAL_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include "optional.hpp"
+
+/* Optionnels dont la valeur est placée dans une arène ("monotonic buffer").
+ *
+ * Typiquement, des milliers d'optionnels sont créés pendant le traitement d'une requête
+ * et meurent tous avec elle. Plutôt qu'une allocation et une libération par valeur,
+ * on ouvre un arena_scope au début de la requête :
+ *
+ *   lib::arena a;                  // une arène par thread de traitement, réutilisée
+ *   ...
+ *   {
+ *       lib::arena_scope scope(a);
+ *       lib::arena_optional<T> o = lib::arena_optional<T>::of(t); // valeur dans l'arène
+ *       ...
+ *   } // fin de la requête : toute l'arène est libérée en replaçant un pointeur
+ *
+ * arena_allocation est une politique d'allocation de heap_storage (cf. optional_allocation.hpp) :
+ * le destructeur de T est toujours appelé, seule la libération de la mémoire est
+ * remplacée par un décompte. Hors de tout arena_scope, elle se replie sur operator new.
+ *
+ * Optionnels qui s'échappent : un optionnel créé dans le scope peut lui survivre (retourné,
+ * déplacé ailleurs, y compris vers un autre thread). Si des valeurs sont encore vivantes à la
+ * fin du scope, l'arène abandonne sa région mémoire courante au lieu de la réutiliser : la
+ * région est libérée par la destruction de sa dernière valeur, et l'arène repart d'une région neuve.
+ *
+ * Une arène n'est utilisée que par le thread qui a ouvert le scope ; seule la libération
+ * des valeurs (le décompte) peut avoir lieu sur d'autres threads.
+ */
+
+namespace lib {
+
+    class arena {
+    private:
+        // Bloc de mémoire de la région, suivi de ses données
+        struct chunk {
+            chunk *next;
+            std::size_t size;
+        };
+
+        /* Ensemble de blocs libéré d'un seul coup.
+         *
+         * Le nombre de valeurs vivantes est local + remote. local n'est modifié que par le
+         * thread propriétaire tant que la région est celle de l'arène active : allocations
+         * et libérations y sont de simples incréments, sans instruction atomique.
+         * Les autres libérations (autre thread, ou après abandon de la région) décrémentent
+         * remote. À l'abandon, l'arène reporte local dans remote : remote compte alors les
+         * valeurs vivantes, et celle qui le fait passer à 0 libère la région
+         * (avant l'abandon, remote est négatif ou nul et ne peut pas atteindre 0 en décrémentant).
+         */
+        struct region {
+            long local;
+            std::atomic<long> remote;
+            chunk *chunks; // du plus récent (et plus grand) au plus ancien
+        };
+
+        /* Chaque valeur est précédée de la région qui la contient (nullptr si elle a été
+         * allouée par operator new), sur header_size octets pour préserver l'alignement.
+         */
+        static const std::size_t header_size = alignof(std::max_align_t);
+
+        region *r; // nullptr avant la première allocation ou après un abandon
+        char *cursor;
+        char *end;
+        std::size_t chunk_size;
+
+        static arena *&current();
+
+        static std::size_t round_up(std::size_t size);
+
+        static chunk *new_chunk(std::size_t size, chunk *next);
+
+        static char *data_of(chunk *c);
+
+        // Libère tous les blocs de la région
+        static void release(region *r);
+
+        // Abandonne la région courante aux valeurs encore vivantes (ou la libère s'il n'y en a plus)
+        void abandon();
+
+        void grow(std::size_t size);
+
+        friend class arena_scope;
+
+    public:
+        static const std::size_t default_chunk_size = 64 * 1024;
+
+        explicit arena(std::size_t chunk_size = default_chunk_size);
+
+        ~arena();
+
+        arena(const arena &other) = delete;
+
+        arena &operator=(const arena &other) = delete;
+
+        // Arène du arena_scope le plus interne du thread courant (nullptr s'il n'y en a pas)
+        static arena *active();
+
+        // size octets alignés sur alignof(std::max_align_t), dans l'arène
+        void *allocate(std::size_t size);
+
+        // size octets hors de toute arène, via operator new
+        static void *allocateGlobal(std::size_t size);
+
+        // Libère une valeur allouée par allocate ou allocateGlobal
+        static void deallocate(void *p);
+
+        /* Fin de requête : si aucune valeur n'est vivante, la mémoire est réutilisée
+         * telle quelle (on ne garde que le plus grand bloc et l'on replace le curseur),
+         * sinon la région est abandonnée aux valeurs qui s'échappent.
+         */
+        void reset();
+
+        // Octets consommés dans la région courante
+        std::size_t used() const;
+
+        // Nombre de valeurs vivantes allouées dans la région courante
+        std::size_t live() const;
+    };
+
+    /* Active une arène pour le thread courant jusqu'à la fin du bloc, puis appelle reset.
+     * Les scopes s'emboîtent : à la destruction, l'arène précédente redevient active.
+     */
+    class arena_scope {
+    private:
+        arena &a;
+        arena *previous;
+
+    public:
+        explicit arena_scope(arena &a);
+
+        ~arena_scope();
+
+        arena_scope(const arena_scope &other) = delete;
+
+        arena_scope &operator=(const arena_scope &other) = delete;
+    };
+
+    template<class T>
+    struct arena_allocation {
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "arena_allocation : alignement de T supérieur à celui de l'arène");
+
+        static void *allocate();
+
+        static void deallocate(void *p);
+    };
+
+    template<class T>
+    using arena_optional = optional<T, heap_storage<T, arena_allocation> >;
+
+    // ============================ arena ===========================
+
+    inline arena *&arena::current() {
+        static thread_local arena *a = nullptr;
+        return a;
+    }
+
+    inline std::size_t arena::round_up(std::size_t size) {
+        return (size + header_size - 1) / header_size * header_size;
+    }
+
+    inline arena::chunk *arena::new_chunk(std::size_t size, chunk *next) {
+        chunk *c = static_cast<chunk *>(::operator new(round_up(sizeof(chunk)) + size));
+        c->next = next;
+        c->size = size;
+        return c;
+    }
+
+    inline char *arena::data_of(chunk *c) {
+        return reinterpret_cast<char *>(c) + round_up(sizeof(chunk));
+    }
+
+    inline void arena::release(region *r) {
+        chunk *c = r->chunks;
+        while (c != nullptr) {
+            chunk *next = c->next;
+            ::operator delete(c);
+            c = next;
+        }
+        delete r;
+    }
+
+    inline arena::arena(std::size_t chunk_size)
+            : r{nullptr}, cursor{nullptr}, end{nullptr}, chunk_size{chunk_size} {}
+
+    inline arena::~arena() {
+        abandon();
+    }
+
+    inline void arena::abandon() {
+        if (r != nullptr) {
+            long local = r->local;
+            if (r->remote.fetch_add(local, std::memory_order_acq_rel) + local == 0) {
+                release(r);
+            }
+        }
+        r = nullptr;
+        cursor = nullptr;
+        end = nullptr;
+    }
+
+    inline arena *arena::active() {
+        return current();
+    }
+
+    inline void arena::grow(std::size_t size) {
+        if (r == nullptr) {
+            r = new region{0, {0}, nullptr};
+        }
+        /* Chaque nouveau bloc est deux fois plus grand que le précédent (au moins size) :
+         * après quelques requêtes, reset ne garde qu'un bloc qui suffit à une requête entière.
+         */
+        std::size_t capacity = r->chunks == nullptr ? chunk_size : 2 * r->chunks->size;
+        if (capacity < size) {
+            capacity = size;
+        }
+        r->chunks = new_chunk(capacity, r->chunks);
+        cursor = data_of(r->chunks);
+        end = cursor + capacity;
+    }
+
+    inline void *arena::allocate(std::size_t size) {
+        std::size_t needed = header_size + round_up(size);
+        if (static_cast<std::size_t>(end - cursor) < needed) {
+            grow(needed);
+        }
+        char *block = cursor;
+        cursor += needed;
+        *reinterpret_cast<region **>(block) = r;
+        r->local++;
+        return block + header_size;
+    }
+
+    inline void *arena::allocateGlobal(std::size_t size) {
+        char *block = static_cast<char *>(::operator new(header_size + size));
+        *reinterpret_cast<region **>(block) = nullptr;
+        return block + header_size;
+    }
+
+    inline void arena::deallocate(void *p) {
+        char *block = static_cast<char *>(p) - header_size;
+        region *owner = *reinterpret_cast<region **>(block);
+        if (owner == nullptr) {
+            ::operator delete(block);
+            return;
+        }
+        // Pas de libération individuelle : la dernière valeur d'une région abandonnée la libère
+        arena *a = current();
+        if (a != nullptr && a->r == owner) {
+            owner->local--;
+        } else if (owner->remote.fetch_sub(1, std::memory_order_acq_rel) - 1 == 0) {
+            release(owner);
+        }
+    }
+
+    inline void arena::reset() {
+        if (r == nullptr) {
+            return;
+        }
+        if (live() != 0) {
+            abandon();
+            return;
+        }
+        /* Plus aucune valeur vivante, donc plus aucune libération concurrente :
+         * on ne garde que le plus récent bloc (le plus grand) et l'on replace le curseur.
+         */
+        r->local = 0;
+        r->remote.store(0, std::memory_order_relaxed);
+        chunk *c = r->chunks->next;
+        while (c != nullptr) {
+            chunk *next = c->next;
+            ::operator delete(c);
+            c = next;
+        }
+        r->chunks->next = nullptr;
+        cursor = data_of(r->chunks);
+        end = cursor + r->chunks->size;
+    }
+
+    inline std::size_t arena::used() const {
+        if (r == nullptr) {
+            return 0;
+        }
+        std::size_t total = static_cast<std::size_t>(cursor - data_of(r->chunks));
+        for (chunk *c = r->chunks->next; c != nullptr; c = c->next) {
+            total += c->size;
+        }
+        return total;
+    }
+
+    inline std::size_t arena::live() const {
+        return r == nullptr ? 0 : static_cast<std::size_t>(r->local + r->remote.load(std::memory_order_acquire));
+    }
+
+    // ========================= arena_scope ========================
+
+    inline arena_scope::arena_scope(arena &a) : a(a), previous{arena::current()} {
+        arena::current() = &a;
+    }
+
+    inline arena_scope::~arena_scope() {
+        arena::current() = previous;
+        a.reset();
+    }
+
+    // ======================= arena_allocation =====================
+
+    template<class T>
+    void *arena_allocation<T>::allocate() {
+        arena *a = arena::active();
+        return a != nullptr ? a->allocate(sizeof(T)) : arena::allocateGlobal(sizeof(T));
+    }
+
+    template<class T>
+    void arena_allocation<T>::deallocate(void *p) {
+        arena::deallocate(p);
+    }
+
+}
+
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef OPTIONAL_CONFIG_HPP
+#define OPTIONAL_CONFIG_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+/* LIB_OPTIONAL_TRACK_OWNERSHIP active (1) ou non (0) le registre des pointeurs
+ * possédés des optionals propriétaires (opt.hpp, optional_pt.hpp).
+ *
+ * Le registre ne sert qu'à détecter qu'un même pointeur est confié à deux
+ * optionals : c'est une aide au débogage. Sauf choix explicite (-D...), il est
+ * actif dans les builds de debug et sous sanitizer, et désactivé lorsque NDEBUG
+ * est défini : construction et destruction n'ont alors plus aucun coût de suivi.
+ */
+#ifndef LIB_OPTIONAL_TRACK_OWNERSHIP
+#if !defined(NDEBUG) || defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define LIB_OPTIONAL_TRACK_OWNERSHIP 1
+#else
+#define LIB_OPTIONAL_TRACK_OWNERSHIP 0
+#endif
+#endif
+
+/* LIB_OPTIONAL_EXCEPTIONS vaut 1 si le code est compilé avec les exceptions, 0 sous
+ * -fno-exceptions (détecté, non modifiable). Dans ce dernier cas, les erreurs signalées
+ * par raise_runtime_error (orElseThrow sur un optionnel vide...) affichent leur message
+ * puis terminent le programme avec std::abort.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define LIB_OPTIONAL_EXCEPTIONS 1
+#else
+#define LIB_OPTIONAL_EXCEPTIONS 0
+#endif
+
+/* LIB_OPTIONAL_CONSTEXPR_BIT_CAST vaut 1 si le compilateur fournit __builtin_bit_cast
+ * (GCC >= 11, Clang >= 9), utilisable dans une expression constante dès C++11 :
+ * les niches de double et float (cf. niche_traits) sont alors constexpr.
+ * Sinon on compare les bits avec memcpy, et optional_stack<double> / <float>
+ * emploient trivial_storage pour rester constexpr (au prix d'un booléen).
+ * On peut forcer la valeur (-DLIB_OPTIONAL_CONSTEXPR_BIT_CAST=0) pour tester ce dernier cas.
+ */
+#ifndef LIB_OPTIONAL_CONSTEXPR_BIT_CAST
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define LIB_OPTIONAL_CONSTEXPR_BIT_CAST 1
+#endif
+#endif
+#endif
+#ifndef LIB_OPTIONAL_CONSTEXPR_BIT_CAST
+#define LIB_OPTIONAL_CONSTEXPR_BIT_CAST 0
+#endif
+
+namespace lib {
+
+    /* Lève std::runtime_error(what), ou termine le programme sans exceptions.
+     * Le type de retour R (jamais retourné) permet l'appel dans une expression
+     * conditionnelle, y compris dans une fonction constexpr :
+     *   return isEmpty() ? raise_runtime_error<const T &>("...") : *p;
+     */
+    template<class R>
+    [[noreturn]] R raise_runtime_error(const char *what);
+
+    template<class R>
+    R raise_runtime_error(const char *what) {
+#if LIB_OPTIONAL_EXCEPTIONS
+        throw std::runtime_error(what);
+#else
+        std::fprintf(stderr, "%s\n", what);
+        std::abort();
+#endif
+    }
+
+}
+
+
+#endif
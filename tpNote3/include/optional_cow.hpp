@@ -0,0 +1,232 @@
+#ifndef OPTIONAL_COW_HPP
+#define OPTIONAL_COW_HPP
+
+#include <atomic>
+#include <utility>
+#include "optional.hpp"
+
+/* Politique de stockage "copy-on-write" pour les grosses valeurs surtout lues.
+ *
+ * La valeur vit sur le tas dans un bloc qui porte aussi son compteur de références
+ * (comptage intrusif : une seule allocation). Copier l'optional ne copie pas la valeur,
+ * les deux instances partagent le bloc ; seul un accès en écriture (getMutable, donc
+ * optional::mutableValue, ou orElseThrow/operator* sur un optional temporaire) sur un
+ * bloc partagé le clone au préalable.
+ *
+ * Count choisit le compteur :
+ * - atomic_refcount : les copies peuvent être partagées entre threads
+ * - local_refcount : compteur ordinaire, moins coûteux, si toutes les copies restent
+ *   dans le même thread
+ *
+ * Comme avec std::shared_ptr, lire la valeur depuis plusieurs threads est sûr ;
+ * une même instance d'optional ne doit pas être modifiée pendant qu'un autre thread la lit.
+ */
+
+namespace lib {
+
+    class atomic_refcount {
+    private:
+        std::atomic<long> n;
+
+    public:
+        explicit atomic_refcount(long n);
+
+        void increment();
+
+        // Retourne true si le compteur atteint 0
+        bool decrement();
+
+        bool unique() const;
+    };
+
+    class local_refcount {
+    private:
+        long n;
+
+    public:
+        explicit local_refcount(long n);
+
+        void increment();
+
+        bool decrement();
+
+        bool unique() const;
+    };
+
+    template<class T, class Count = atomic_refcount>
+    class cow_storage {
+    private:
+        struct block {
+            Count count;
+            T value;
+
+            template<class... Args>
+            explicit block(Args &&... args);
+        };
+
+        block *b; // nullptr si vide
+
+        // Abandonne la référence de this sur son bloc
+        void release();
+
+    public:
+        template<class U>
+        using rebind = cow_storage<U, Count>;
+
+        cow_storage() noexcept;
+
+        template<class... Args>
+        explicit cow_storage(in_place_t, Args &&... args);
+
+        // La copie partage le bloc de other
+        cow_storage(const cow_storage<T, Count> &other) noexcept;
+
+        cow_storage<T, Count> &operator=(const cow_storage<T, Count> &other) noexcept;
+
+        cow_storage(cow_storage<T, Count> &&other) noexcept;
+
+        cow_storage<T, Count> &operator=(cow_storage<T, Count> &&other) noexcept;
+
+        ~cow_storage();
+
+        bool isEmpty() const;
+
+        const T *get() const;
+
+        // Clone la valeur si le bloc est partagé
+        T *getMutable();
+
+        // true ssi la valeur n'est partagée avec aucune autre instance
+        bool unique() const;
+    };
+
+    template<class T>
+    using cow_optional = optional<T, cow_storage<T> >;
+
+    // ======================= atomic_refcount ======================
+
+    inline atomic_refcount::atomic_refcount(long n) : n{n} {}
+
+    inline void atomic_refcount::increment() {
+        // Relâché : on possède déjà une référence, le bloc ne peut pas disparaître
+        n.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline bool atomic_refcount::decrement() {
+        // acq_rel : les écritures des autres détenteurs sont visibles avant la destruction
+        return n.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    inline bool atomic_refcount::unique() const {
+        return n.load(std::memory_order_acquire) == 1;
+    }
+
+    // ======================== local_refcount ======================
+
+    inline local_refcount::local_refcount(long n) : n{n} {}
+
+    inline void local_refcount::increment() {
+        n++;
+    }
+
+    inline bool local_refcount::decrement() {
+        return --n == 0;
+    }
+
+    inline bool local_refcount::unique() const {
+        return n == 1;
+    }
+
+    // ========================= cow_storage ========================
+
+    template<class T, class Count>
+    template<class... Args>
+    cow_storage<T, Count>::block::block(Args &&... args) : count{1}, value(std::forward<Args>(args)...) {}
+
+    template<class T, class Count>
+    void cow_storage<T, Count>::release() {
+        if (b != nullptr && b->count.decrement()) {
+            delete b;
+        }
+        b = nullptr;
+    }
+
+    template<class T, class Count>
+    cow_storage<T, Count>::cow_storage() noexcept : b{nullptr} {}
+
+    template<class T, class Count>
+    template<class... Args>
+    cow_storage<T, Count>::cow_storage(in_place_t, Args &&... args) : b{new block(std::forward<Args>(args)...)} {}
+
+    template<class T, class Count>
+    cow_storage<T, Count>::cow_storage(const cow_storage<T, Count> &other) noexcept : b{other.b} {
+        if (b != nullptr) {
+            b->count.increment();
+        }
+    }
+
+    template<class T, class Count>
+    cow_storage<T, Count> &cow_storage<T, Count>::operator=(const cow_storage<T, Count> &other) noexcept {
+        if (b != other.b) {
+            release();
+            b = other.b;
+            if (b != nullptr) {
+                b->count.increment();
+            }
+        }
+        return *this;
+    }
+
+    template<class T, class Count>
+    cow_storage<T, Count>::cow_storage(cow_storage<T, Count> &&other) noexcept : b{other.b} {
+        other.b = nullptr;
+    }
+
+    template<class T, class Count>
+    cow_storage<T, Count> &cow_storage<T, Count>::operator=(cow_storage<T, Count> &&other) noexcept {
+        if (&other != this) {
+            release();
+            b = other.b;
+            other.b = nullptr;
+        }
+        return *this;
+    }
+
+    template<class T, class Count>
+    cow_storage<T, Count>::~cow_storage() {
+        release();
+    }
+
+    template<class T, class Count>
+    bool cow_storage<T, Count>::isEmpty() const {
+        return b == nullptr;
+    }
+
+    template<class T, class Count>
+    const T *cow_storage<T, Count>::get() const {
+        return b == nullptr ? nullptr : &b->value;
+    }
+
+    template<class T, class Count>
+    T *cow_storage<T, Count>::getMutable() {
+        if (b == nullptr) {
+            return nullptr;
+        }
+        if (!b->count.unique()) {
+            // Copie à l'écriture : this obtient son propre bloc, les autres gardent l'ancien
+            block *copy = new block(b->value);
+            release();
+            b = copy;
+        }
+        return &b->value;
+    }
+
+    template<class T, class Count>
+    bool cow_storage<T, Count>::unique() const {
+        return b == nullptr || b->count.unique();
+    }
+
+}
+
+
+#endif
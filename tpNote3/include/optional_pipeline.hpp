@@ -0,0 +1,295 @@
+#ifndef OPTIONAL_PIPELINE_HPP
+#define OPTIONAL_PIPELINE_HPP
+
+#include <type_traits>
+#include <utility>
+#include "optional_stack.hpp"
+
+/* Chaînes paresseuses ("expression templates") sur optional_stack.
+ *
+ * Sur optional_stack, opt.filter(p).transform(f).filter(q) construit un optional_stack
+ * complet à chaque étape, et copie donc la valeur à chaque étape. Ici :
+ *
+ *   lib::lazy(opt).filter(p).map(f).filter(q).orElse(x)
+ *
+ * filter et map ne calculent rien : elles retournent un objet expression dont le type
+ * décrit toute la chaîne (optional_pipeline<pipeline_filter<pipeline_map<...>, Q> >).
+ * Seul un terminal (orElse, orElseThrow, collect) évalue la chaîne, en une seule passe :
+ * chaque étape passe la valeur à la suivante par référence, sans optionnel intermédiaire.
+ * La valeur n'est copiée qu'une fois, dans le résultat du terminal (et déplacée
+ * si elle a été produite par un map).
+ *
+ * Contrairement à optional_stack::map, map prend ici une fonction qui retourne
+ * directement une valeur (comme transform).
+ *
+ * Attention : l'expression référence l'optional_stack de départ sans le copier.
+ * Elle doit être évaluée avant la destruction de celui-ci (en pratique, dans la même
+ * expression que lazy(...)).
+ */
+
+namespace lib {
+
+    /* Noeuds de l'expression. Chacun définit :
+     * - value_type : le type de la valeur en sortie du noeud
+     * - eval(k, e) : évalue le noeud puis retourne k(valeur) si une valeur est présente,
+     *   e() sinon ; k et e ont un même type de retour K::result_type
+     */
+
+    template<class T>
+    class pipeline_source {
+    private:
+        const optional_stack<T> *o;
+
+    public:
+        typedef T value_type;
+
+        explicit pipeline_source(const optional_stack<T> &o);
+
+        template<class K, class E>
+        typename K::result_type eval(const K &k, const E &e) const;
+    };
+
+    template<class Prev, class P>
+    class pipeline_filter {
+    private:
+        Prev prev;
+        P predicate;
+
+        // Transmet à k les valeurs qui satisfont predicate
+        template<class K, class E>
+        struct sink {
+            typedef typename K::result_type result_type;
+
+            const P &predicate;
+            const K &k;
+            const E &e;
+
+            template<class V>
+            result_type operator()(V &&v) const;
+        };
+
+    public:
+        typedef typename Prev::value_type value_type;
+
+        pipeline_filter(const Prev &prev, const P &predicate);
+
+        template<class K, class E>
+        typename K::result_type eval(const K &k, const E &e) const;
+    };
+
+    template<class Prev, class F>
+    class pipeline_map {
+    private:
+        Prev prev;
+        F f;
+
+        // Transmet à k le résultat de f (un temporaire, passé par référence rvalue)
+        template<class K, class E>
+        struct sink {
+            typedef typename K::result_type result_type;
+
+            const F &f;
+            const K &k;
+
+            template<class V>
+            result_type operator()(V &&v) const;
+        };
+
+    public:
+        typedef typename value_result<const F &, typename Prev::value_type>::type value_type;
+
+        pipeline_map(const Prev &prev, const F &f);
+
+        template<class K, class E>
+        typename K::result_type eval(const K &k, const E &e) const;
+    };
+
+    template<class Expr>
+    class optional_pipeline {
+    public:
+        typedef typename Expr::value_type value_type;
+
+    private:
+        Expr expr;
+
+        // Terminaux : construction du résultat à partir de la valeur finale, ou en son absence
+        template<class R>
+        struct construct {
+            typedef R result_type;
+
+            template<class V>
+            R operator()(V &&v) const;
+        };
+
+        struct fallback {
+            const value_type &other;
+
+            value_type operator()() const;
+        };
+
+        struct raise {
+            value_type operator()() const;
+        };
+
+        struct collect_value {
+            typedef optional_stack<value_type> result_type;
+
+            template<class V>
+            optional_stack<value_type> operator()(V &&v) const;
+        };
+
+        struct collect_empty {
+            optional_stack<value_type> operator()() const;
+        };
+
+    public:
+        explicit optional_pipeline(const Expr &expr);
+
+        template<class P>
+        optional_pipeline<pipeline_filter<Expr, typename std::decay<P>::type> > filter(P &&predicate) const;
+
+        template<class F>
+        optional_pipeline<pipeline_map<Expr, typename std::decay<F>::type> > map(F &&f) const;
+
+        value_type orElse(const value_type &other) const;
+
+        value_type orElseThrow() const;
+
+        // Évalue la chaîne et construit son résultat dans un optional_stack
+        optional_stack<value_type> collect() const;
+    };
+
+    // Point d'entrée d'une chaîne paresseuse
+    template<class T>
+    optional_pipeline<pipeline_source<T> > lazy(const optional_stack<T> &o);
+
+    // ======================= pipeline_source ======================
+
+    template<class T>
+    pipeline_source<T>::pipeline_source(const optional_stack<T> &o) : o{&o} {}
+
+    template<class T>
+    template<class K, class E>
+    typename K::result_type pipeline_source<T>::eval(const K &k, const E &e) const {
+        if (o->isEmpty()) {
+            return e();
+        }
+        return k(*o->pointer_to_t());
+    }
+
+    // ======================= pipeline_filter ======================
+
+    template<class Prev, class P>
+    template<class K, class E>
+    template<class V>
+    typename K::result_type pipeline_filter<Prev, P>::sink<K, E>::operator()(V &&v) const {
+        if (!predicate(v)) {
+            return e();
+        }
+        return k(std::forward<V>(v));
+    }
+
+    template<class Prev, class P>
+    pipeline_filter<Prev, P>::pipeline_filter(const Prev &prev, const P &predicate)
+            : prev(prev), predicate(predicate) {}
+
+    template<class Prev, class P>
+    template<class K, class E>
+    typename K::result_type pipeline_filter<Prev, P>::eval(const K &k, const E &e) const {
+        return prev.eval(sink<K, E>{predicate, k, e}, e);
+    }
+
+    // ======================== pipeline_map ========================
+
+    template<class Prev, class F>
+    template<class K, class E>
+    template<class V>
+    typename K::result_type pipeline_map<Prev, F>::sink<K, E>::operator()(V &&v) const {
+        return k(f(std::forward<V>(v)));
+    }
+
+    template<class Prev, class F>
+    pipeline_map<Prev, F>::pipeline_map(const Prev &prev, const F &f) : prev(prev), f(f) {}
+
+    template<class Prev, class F>
+    template<class K, class E>
+    typename K::result_type pipeline_map<Prev, F>::eval(const K &k, const E &e) const {
+        return prev.eval(sink<K, E>{f, k}, e);
+    }
+
+    // ====================== optional_pipeline =====================
+
+    template<class Expr>
+    template<class R>
+    template<class V>
+    R optional_pipeline<Expr>::construct<R>::operator()(V &&v) const {
+        // Copie depuis l'optional_stack de départ, ou déplacement du résultat d'un map
+        return R(std::forward<V>(v));
+    }
+
+    template<class Expr>
+    typename optional_pipeline<Expr>::value_type optional_pipeline<Expr>::fallback::operator()() const {
+        return other;
+    }
+
+    template<class Expr>
+    typename optional_pipeline<Expr>::value_type optional_pipeline<Expr>::raise::operator()() const {
+        return raise_runtime_error<value_type>("Cannot get value of None type");
+    }
+
+    template<class Expr>
+    template<class V>
+    optional_stack<typename optional_pipeline<Expr>::value_type>
+    optional_pipeline<Expr>::collect_value::operator()(V &&v) const {
+        return optional_stack<value_type>(in_place, std::forward<V>(v));
+    }
+
+    template<class Expr>
+    optional_stack<typename optional_pipeline<Expr>::value_type>
+    optional_pipeline<Expr>::collect_empty::operator()() const {
+        return optional_stack<value_type>::empty();
+    }
+
+    template<class Expr>
+    optional_pipeline<Expr>::optional_pipeline(const Expr &expr) : expr(expr) {}
+
+    template<class Expr>
+    template<class P>
+    optional_pipeline<pipeline_filter<Expr, typename std::decay<P>::type> >
+    optional_pipeline<Expr>::filter(P &&predicate) const {
+        typedef pipeline_filter<Expr, typename std::decay<P>::type> Node;
+        return optional_pipeline<Node>(Node(expr, std::forward<P>(predicate)));
+    }
+
+    template<class Expr>
+    template<class F>
+    optional_pipeline<pipeline_map<Expr, typename std::decay<F>::type> >
+    optional_pipeline<Expr>::map(F &&f) const {
+        typedef pipeline_map<Expr, typename std::decay<F>::type> Node;
+        return optional_pipeline<Node>(Node(expr, std::forward<F>(f)));
+    }
+
+    template<class Expr>
+    typename optional_pipeline<Expr>::value_type optional_pipeline<Expr>::orElse(const value_type &other) const {
+        return expr.eval(construct<value_type>(), fallback{other});
+    }
+
+    template<class Expr>
+    typename optional_pipeline<Expr>::value_type optional_pipeline<Expr>::orElseThrow() const {
+        return expr.eval(construct<value_type>(), raise());
+    }
+
+    template<class Expr>
+    optional_stack<typename optional_pipeline<Expr>::value_type> optional_pipeline<Expr>::collect() const {
+        return expr.eval(collect_value(), collect_empty());
+    }
+
+    template<class T>
+    optional_pipeline<pipeline_source<T> > lazy(const optional_stack<T> &o) {
+        return optional_pipeline<pipeline_source<T> >(pipeline_source<T>(o));
+    }
+
+}
+
+
+#endif
@@ -5,6 +5,8 @@
 #include <functional>
 #include <vector>
 #include <algorithm>
+#include "optional_config.hpp"
+#include "sharded_pointer_set.hpp"
 
 
 namespace lib {
@@ -14,12 +16,16 @@ namespace lib {
     private:
         T *t;
 
-        static std::vector<T *> owned_ptrs; // pointeurs manipulés par les instances de optional
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        // pointeurs manipulés par les instances de optional, partagé entre threads
+        static sharded_pointer_set<T> owned_ptrs;
+#endif
 
         static bool isOwned(T *t);
 
-        // Ajoute le pointeur à la liste des pointeurs owned
-        static void addToOwned(T *t);
+        // Ajoute le pointeur à la liste des pointeurs owned,
+        // retourne false s'il y était déjà (test et ajout atomiques)
+        static bool addToOwned(T *t);
 
         // Supprime le pointeur de la liste des pointeurs owned
         static void removeFromOwned(T *t);
@@ -229,35 +235,29 @@ namespace lib {
 
     template<class T>
     optional<T>::optional(T *t) : t{t} {
-        if (isOwned(t)) {
+        /* On ne teste pas isOwned avant d'ajouter : entre les deux appels
+         * un autre thread pourrait s'approprier le même pointeur.
+         */
+        if (!addToOwned(t)) {
             throw std::runtime_error("Pointer is already owned");
         }
-        addToOwned(t);
     }
 
     template<class T>
     optional<T>::optional() : t{nullptr} {}
 
+    /* Transfert d'appartenance : le pointeur reste dans owned_ptrs,
+     * seule l'instance qui le possède change.
+     * t n'est pas encore initialisé dans un constructeur, il n'y a rien à libérer.
+     */
     template<class T>
-    optional<T>::optional(optional<T> &other) {
-        if (t == other.t) return;
-        if (t != nullptr) {
-            removeFromOwned(t);
-            delete t;
-        }
-        t = other.release();
-        addToOwned(t);
+    optional<T>::optional(optional<T> &other) : t{other.t} {
+        other.t = nullptr;
     }
 
     template<class T>
-    optional<T>::optional(optional<T> &&other) noexcept {
-        if (t == other.t) return;
-        if (t != nullptr) {
-            removeFromOwned(t);
-            delete t;
-        }
-        t = other.release();
-        addToOwned(t);
+    optional<T>::optional(optional<T> &&other) noexcept : t{other.t} {
+        other.t = nullptr;
     }
 
     template<class T>
@@ -267,37 +267,47 @@ namespace lib {
             removeFromOwned(t);
             delete t;
         }
-        t = other.release();
-        addToOwned(t);
+        t = other.t;
+        other.t = nullptr;
         return *this;
     }
 
     template<class T>
     bool optional<T>::isOwned(T *t) {
-        for (unsigned i = 0; i < owned_ptrs.size(); i++) {
-            if (owned_ptrs.at(i) == t) return true;
-        }
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        return owned_ptrs.contains(t);
+#else
+        (void) t;
         return false;
+#endif
     }
 
     template<class T>
-    void optional<T>::addToOwned(T *t) {
-        owned_ptrs.push_back(t);
+    bool optional<T>::addToOwned(T *t) {
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        return t == nullptr || owned_ptrs.insert(t);
+#else
+        (void) t;
+        return true;
+#endif
     }
 
     template<class T>
     void optional<T>::removeFromOwned(T *t) {
-        auto f = std::find(owned_ptrs.begin(), owned_ptrs.end(), t);
-        if (f != owned_ptrs.end()) {
-            owned_ptrs.erase(f);
-        }
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+        owned_ptrs.erase(t);
+#else
+        (void) t;
+#endif
     }
 
 
     template<class T>
-    const optional_ptr<T> &optional<T>::none = optional_ptr<T>();
+    const optional<T> &optional<T>::none = optional<T>();
 
-    template<class T> std::vector<T *> optional<T>::owned_ptrs;
+#if LIB_OPTIONAL_TRACK_OWNERSHIP
+    template<class T> sharded_pointer_set<T> optional<T>::owned_ptrs;
+#endif
 
 }
 
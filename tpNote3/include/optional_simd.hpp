@@ -0,0 +1,538 @@
+#ifndef OPTIONAL_SIMD_HPP
+#define OPTIONAL_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "optional_vector.hpp"
+
+/* Versions par lots de filter et map sur un optional_vector (valeurs + bitmap de présence).
+ *
+ * Là où optional_stack::filter / map appellent un prédicat élément par élément,
+ * filterCompare et mapAffine traitent tout le tableau, plusieurs éléments à la fois
+ * avec SSE2 (128 bits) ou AVX2 (256 bits). Le jeu d'instructions est choisi à l'exécution
+ * (CPUID, via __builtin_cpu_supports), avec un repli scalaire.
+ * Les éléments absents ne sont pas testés un à un : ils sont masqués.
+ *
+ * Types pris en charge : std::int32_t, std::int64_t, float, double.
+ * Les noyaux SSE2/AVX2 ne sont compilés qu'avec GCC sur x86 ("#pragma GCC target") ;
+ * ailleurs seule la version scalaire est disponible.
+ */
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(__clang__)
+#define LIB_OPTIONAL_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define LIB_OPTIONAL_SIMD_X86 0
+#endif
+
+namespace lib {
+
+    // Prédicat x op value de filterCompare
+    enum class compare {
+        less, less_equal, greater, greater_equal, equal, not_equal
+    };
+
+    // Jeux d'instructions, du moins au plus performant
+    enum class simd_level {
+        scalar, sse2, avx2
+    };
+
+    template<class T>
+    struct is_simd_type : std::integral_constant<bool,
+            std::is_same<T, std::int32_t>::value || std::is_same<T, std::int64_t>::value ||
+            std::is_same<T, float>::value || std::is_same<T, double>::value> {
+    };
+
+    // Meilleur jeu d'instructions du processeur, détecté une seule fois
+    simd_level simdLevel();
+
+    /* Rend absents les éléments présents x de v pour lesquels (x op value) est faux.
+     * Comme pour les comparaisons scalaires, un NaN ne satisfait que not_equal.
+     */
+    template<class T>
+    void filterCompare(optional_vector<T> &v, compare op, T value);
+
+    /* Remplace chaque élément présent x de v par a * x + b ; les éléments absents
+     * ne sont pas modifiés. Arithmétique modulo 2^n pour les entiers (pas de débordement
+     * indéfini), et sans FMA pour les flottants : le résultat ne dépend pas du jeu d'instructions.
+     */
+    template<class T>
+    void mapAffine(optional_vector<T> &v, T a, T b);
+
+    // Variantes imposant un jeu d'instructions (plafonné à simdLevel()), pour les benchmarks
+    template<class T>
+    void filterCompare(optional_vector<T> &v, compare op, T value, simd_level level);
+
+    template<class T>
+    void mapAffine(optional_vector<T> &v, T a, T b, simd_level level);
+
+    // ========================= scalaire ===========================
+
+    template<compare Op, class T>
+    bool compare_scalar(T x, T value) {
+        switch (Op) {
+            case compare::less:
+                return x < value;
+            case compare::less_equal:
+                return x <= value;
+            case compare::greater:
+                return x > value;
+            case compare::greater_equal:
+                return x >= value;
+            case compare::equal:
+                return x == value;
+            case compare::not_equal:
+                return x != value;
+        }
+        return false;
+    }
+
+    // Entiers : calcul en non signé, modulo 2^n comme les instructions vectorielles
+    template<class T>
+    T affine_scalar(T x, T a, T b) {
+        typedef typename std::make_unsigned<T>::type U;
+        return static_cast<T>(static_cast<U>(static_cast<U>(x) * static_cast<U>(a)) + static_cast<U>(b));
+    }
+
+    inline float affine_scalar(float x, float a, float b) {
+        return x * a + b;
+    }
+
+    inline double affine_scalar(double x, double a, double b) {
+        return x * a + b;
+    }
+
+    namespace simd_scalar {
+
+        // Une "voie" par vecteur
+        template<class T>
+        struct ops {
+            typedef T vec;
+            static const int lanes = 1;
+
+            static vec load(const T *p) { return *p; }
+
+            static void store(T *p, vec x) { *p = x; }
+
+            static vec set1(T value) { return value; }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) { return compare_scalar<Op>(x, value); }
+
+            static vec affine(vec x, vec a, vec b) { return affine_scalar(x, a, b); }
+
+            static vec blend(vec x, vec y, unsigned present) { return present ? y : x; }
+        };
+
+#include "optional_simd_kernels.inc"
+
+    }
+
+#if LIB_OPTIONAL_SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+    namespace simd_sse2 {
+
+        template<class T>
+        struct ops;
+
+        template<>
+        struct ops<std::int32_t> {
+            typedef __m128i vec;
+            static const int lanes = 4;
+
+            static vec load(const std::int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+            static void store(std::int32_t *p, vec x) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x); }
+
+            static vec set1(std::int32_t value) { return _mm_set1_epi32(value); }
+
+            static unsigned mask(vec m) { return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(m))); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return mask(_mm_cmplt_epi32(x, value));
+                    case compare::less_equal:
+                        return mask(_mm_cmpgt_epi32(x, value)) ^ 0xFu;
+                    case compare::greater:
+                        return mask(_mm_cmpgt_epi32(x, value));
+                    case compare::greater_equal:
+                        return mask(_mm_cmplt_epi32(x, value)) ^ 0xFu;
+                    case compare::equal:
+                        return mask(_mm_cmpeq_epi32(x, value));
+                    case compare::not_equal:
+                        return mask(_mm_cmpeq_epi32(x, value)) ^ 0xFu;
+                }
+                return 0;
+            }
+
+            // Pas de multiplication 32 bits (SSE4.1) : produits des voies paires et impaires
+            static vec affine(vec x, vec a, vec b) {
+                __m128i even = _mm_mul_epu32(x, a);
+                __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(a, 32));
+                __m128i product = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                                     _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+                return _mm_add_epi32(product, b);
+            }
+
+            // Masque de voies à partir des bits de présence
+            static vec lane_mask(unsigned present) {
+                const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+                return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(present)), bits), bits);
+            }
+
+            static vec blend(vec x, vec y, unsigned present) {
+                __m128i m = lane_mask(present);
+                return _mm_or_si128(_mm_and_si128(m, y), _mm_andnot_si128(m, x));
+            }
+        };
+
+        // Pas de comparaison 64 bits avant SSE4.2 : version scalaire
+        template<>
+        struct ops<std::int64_t> : simd_scalar::ops<std::int64_t> {
+        };
+
+        template<>
+        struct ops<float> {
+            typedef __m128 vec;
+            static const int lanes = 4;
+
+            static vec load(const float *p) { return _mm_loadu_ps(p); }
+
+            static void store(float *p, vec x) { _mm_storeu_ps(p, x); }
+
+            static vec set1(float value) { return _mm_set1_ps(value); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(x, value)));
+                    case compare::less_equal:
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(x, value)));
+                    case compare::greater:
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(x, value)));
+                    case compare::greater_equal:
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpge_ps(x, value)));
+                    case compare::equal:
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(x, value)));
+                    case compare::not_equal:
+                        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpneq_ps(x, value)));
+                }
+                return 0;
+            }
+
+            static vec affine(vec x, vec a, vec b) { return _mm_add_ps(_mm_mul_ps(x, a), b); }
+
+            static vec blend(vec x, vec y, unsigned present) {
+                __m128 m = _mm_castsi128_ps(ops<std::int32_t>::lane_mask(present));
+                return _mm_or_ps(_mm_and_ps(m, y), _mm_andnot_ps(m, x));
+            }
+        };
+
+        template<>
+        struct ops<double> {
+            typedef __m128d vec;
+            static const int lanes = 2;
+
+            static vec load(const double *p) { return _mm_loadu_pd(p); }
+
+            static void store(double *p, vec x) { _mm_storeu_pd(p, x); }
+
+            static vec set1(double value) { return _mm_set1_pd(value); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmplt_pd(x, value)));
+                    case compare::less_equal:
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmple_pd(x, value)));
+                    case compare::greater:
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpgt_pd(x, value)));
+                    case compare::greater_equal:
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpge_pd(x, value)));
+                    case compare::equal:
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(x, value)));
+                    case compare::not_equal:
+                        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpneq_pd(x, value)));
+                }
+                return 0;
+            }
+
+            static vec affine(vec x, vec a, vec b) { return _mm_add_pd(_mm_mul_pd(x, a), b); }
+
+            static vec blend(vec x, vec y, unsigned present) {
+                // Chaque voie de 64 bits est couverte par deux mots de 32 bits égaux
+                const __m128i bits = _mm_setr_epi32(1, 1, 2, 2);
+                __m128i m = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(present)), bits), bits);
+                __m128d md = _mm_castsi128_pd(m);
+                return _mm_or_pd(_mm_and_pd(md, y), _mm_andnot_pd(md, x));
+            }
+        };
+
+#include "optional_simd_kernels.inc"
+
+    }
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+    namespace simd_avx2 {
+
+        template<class T>
+        struct ops;
+
+        template<>
+        struct ops<std::int32_t> {
+            typedef __m256i vec;
+            static const int lanes = 8;
+
+            static vec load(const std::int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+            static void store(std::int32_t *p, vec x) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x); }
+
+            static vec set1(std::int32_t value) { return _mm256_set1_epi32(value); }
+
+            static unsigned mask(vec m) { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return mask(_mm256_cmpgt_epi32(value, x));
+                    case compare::less_equal:
+                        return mask(_mm256_cmpgt_epi32(x, value)) ^ 0xFFu;
+                    case compare::greater:
+                        return mask(_mm256_cmpgt_epi32(x, value));
+                    case compare::greater_equal:
+                        return mask(_mm256_cmpgt_epi32(value, x)) ^ 0xFFu;
+                    case compare::equal:
+                        return mask(_mm256_cmpeq_epi32(x, value));
+                    case compare::not_equal:
+                        return mask(_mm256_cmpeq_epi32(x, value)) ^ 0xFFu;
+                }
+                return 0;
+            }
+
+            static vec affine(vec x, vec a, vec b) { return _mm256_add_epi32(_mm256_mullo_epi32(x, a), b); }
+
+            static vec lane_mask(unsigned present) {
+                const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+                return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(present)), bits), bits);
+            }
+
+            static vec blend(vec x, vec y, unsigned present) { return _mm256_blendv_epi8(x, y, lane_mask(present)); }
+        };
+
+        template<>
+        struct ops<std::int64_t> {
+            typedef __m256i vec;
+            static const int lanes = 4;
+
+            static vec load(const std::int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+            static void store(std::int64_t *p, vec x) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x); }
+
+            static vec set1(std::int64_t value) { return _mm256_set1_epi64x(value); }
+
+            static unsigned mask(vec m) { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m))); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return mask(_mm256_cmpgt_epi64(value, x));
+                    case compare::less_equal:
+                        return mask(_mm256_cmpgt_epi64(x, value)) ^ 0xFu;
+                    case compare::greater:
+                        return mask(_mm256_cmpgt_epi64(x, value));
+                    case compare::greater_equal:
+                        return mask(_mm256_cmpgt_epi64(value, x)) ^ 0xFu;
+                    case compare::equal:
+                        return mask(_mm256_cmpeq_epi64(x, value));
+                    case compare::not_equal:
+                        return mask(_mm256_cmpeq_epi64(x, value)) ^ 0xFu;
+                }
+                return 0;
+            }
+
+            /* Pas de multiplication 64 bits avant AVX-512 : modulo 2^64,
+             * x * a = lo(x) * lo(a) + ((hi(x) * lo(a) + lo(x) * hi(a)) << 32)
+             */
+            static vec affine(vec x, vec a, vec b) {
+                __m256i low = _mm256_mul_epu32(x, a);
+                __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), a),
+                                                 _mm256_mul_epu32(x, _mm256_srli_epi64(a, 32)));
+                return _mm256_add_epi64(_mm256_add_epi64(low, _mm256_slli_epi64(cross, 32)), b);
+            }
+
+            static vec lane_mask(unsigned present) {
+                const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+                return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(present), bits), bits);
+            }
+
+            static vec blend(vec x, vec y, unsigned present) { return _mm256_blendv_epi8(x, y, lane_mask(present)); }
+        };
+
+        template<>
+        struct ops<float> {
+            typedef __m256 vec;
+            static const int lanes = 8;
+
+            static vec load(const float *p) { return _mm256_loadu_ps(p); }
+
+            static void store(float *p, vec x) { _mm256_storeu_ps(p, x); }
+
+            static vec set1(float value) { return _mm256_set1_ps(value); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_LT_OQ)));
+                    case compare::less_equal:
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_LE_OQ)));
+                    case compare::greater:
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_GT_OQ)));
+                    case compare::greater_equal:
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_GE_OQ)));
+                    case compare::equal:
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_EQ_OQ)));
+                    case compare::not_equal:
+                        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, value, _CMP_NEQ_UQ)));
+                }
+                return 0;
+            }
+
+            static vec affine(vec x, vec a, vec b) { return _mm256_add_ps(_mm256_mul_ps(x, a), b); }
+
+            static vec blend(vec x, vec y, unsigned present) {
+                return _mm256_blendv_ps(x, y, _mm256_castsi256_ps(ops<std::int32_t>::lane_mask(present)));
+            }
+        };
+
+        template<>
+        struct ops<double> {
+            typedef __m256d vec;
+            static const int lanes = 4;
+
+            static vec load(const double *p) { return _mm256_loadu_pd(p); }
+
+            static void store(double *p, vec x) { _mm256_storeu_pd(p, x); }
+
+            static vec set1(double value) { return _mm256_set1_pd(value); }
+
+            template<compare Op>
+            static unsigned test(vec x, vec value) {
+                switch (Op) {
+                    case compare::less:
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_LT_OQ)));
+                    case compare::less_equal:
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_LE_OQ)));
+                    case compare::greater:
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_GT_OQ)));
+                    case compare::greater_equal:
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_GE_OQ)));
+                    case compare::equal:
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_EQ_OQ)));
+                    case compare::not_equal:
+                        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, value, _CMP_NEQ_UQ)));
+                }
+                return 0;
+            }
+
+            static vec affine(vec x, vec a, vec b) { return _mm256_add_pd(_mm256_mul_pd(x, a), b); }
+
+            static vec blend(vec x, vec y, unsigned present) {
+                return _mm256_blendv_pd(x, y, _mm256_castsi256_pd(ops<std::int64_t>::lane_mask(present)));
+            }
+        };
+
+#include "optional_simd_kernels.inc"
+
+    }
+
+#pragma GCC pop_options
+
+#endif
+
+    // ========================= dispatch ===========================
+
+    inline simd_level detect_simd_level() {
+#if LIB_OPTIONAL_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_level::avx2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return simd_level::sse2;
+        }
+#endif
+        return simd_level::scalar;
+    }
+
+    inline simd_level simdLevel() {
+        static const simd_level level = detect_simd_level();
+        return level;
+    }
+
+    template<class T>
+    void filterCompare(optional_vector<T> &v, compare op, T value) {
+        filterCompare(v, op, value, simdLevel());
+    }
+
+    template<class T>
+    void mapAffine(optional_vector<T> &v, T a, T b) {
+        mapAffine(v, a, b, simdLevel());
+    }
+
+    template<class T>
+    void filterCompare(optional_vector<T> &v, compare op, T value, simd_level level) {
+        static_assert(is_simd_type<T>::value, "filterCompare : T doit être int32_t, int64_t, float ou double");
+        if (level > simdLevel()) {
+            level = simdLevel();
+        }
+#if LIB_OPTIONAL_SIMD_X86
+        if (level == simd_level::avx2) {
+            simd_avx2::filter_dispatch(v.data(), v.validityData(), v.size(), op, value);
+            return;
+        }
+        if (level == simd_level::sse2) {
+            simd_sse2::filter_dispatch(v.data(), v.validityData(), v.size(), op, value);
+            return;
+        }
+#endif
+        simd_scalar::filter_dispatch(v.data(), v.validityData(), v.size(), op, value);
+    }
+
+    template<class T>
+    void mapAffine(optional_vector<T> &v, T a, T b, simd_level level) {
+        static_assert(is_simd_type<T>::value, "mapAffine : T doit être int32_t, int64_t, float ou double");
+        if (level > simdLevel()) {
+            level = simdLevel();
+        }
+#if LIB_OPTIONAL_SIMD_X86
+        if (level == simd_level::avx2) {
+            simd_avx2::affine_words(v.data(), v.validityData(), v.size(), a, b);
+            return;
+        }
+        if (level == simd_level::sse2) {
+            simd_sse2::affine_words(v.data(), v.validityData(), v.size(), a, b);
+            return;
+        }
+#endif
+        simd_scalar::affine_words(v.data(), v.validityData(), v.size(), a, b);
+    }
+
+}
+
+
+#endif
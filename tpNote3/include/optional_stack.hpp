@@ -3,6 +3,9 @@
 
 #include <ostream>
 #include <functional>
+#include "optional_config.hpp"
+#include "optional_storage.hpp"
+#include "optional_traits.hpp"
 
 // =====================================================
 // ATTENTION, ceci n'est pas l'implémentation demandée dans le tp car l'on ne manipule pas
@@ -11,78 +14,128 @@
 
 namespace lib {
 
+    template<class T>
+    class optional_stack;
+
+    template<class U>
+    struct is_optional_type<optional_stack<U> > : std::true_type {
+    };
+
+    /* Type retourné par transform : l'optional_stack retourné par f tel quel,
+     * ou bien un optional_stack de la valeur retournée par f.
+     */
+    template<class F, class T>
+    struct optional_stack_transform {
+        typedef typename value_result<F, T>::type value_type;
+
+        typedef typename std::conditional<
+                is_optional_type<value_type>::value,
+                value_type,
+                optional_stack<value_type>
+        >::type type;
+    };
+
     template<class T>
     class optional_stack {
     private:
+        template<class U>
+        friend class optional_stack;
+
+        // Chaînes paresseuses (cf. optional_pipeline.hpp)
+        template<class U>
+        friend class pipeline_source;
+
+        template<class Expr>
+        friend class optional_pipeline;
+
         /* On stocke le contenu du pointeur dans la pile (on ne
          * stocke pas le pointeur lui-même).
          *
          * Cela nous exempt de la gestion des pointeurs.
+         *
+         * inline_storage (cf. optional_storage.hpp) réserve un tableau de char
+         * de la taille de T, aligné comme T (alignas(alignof(T))), et y construit
+         * la valeur avec un "placement new". Il se charge aussi d'appeler
+         * le destructeur de T uniquement lorsqu'une valeur a été construite.
+         *
+         * Si T déclare une valeur sentinelle (niche_traits : pointeurs, double, float,
+         * énumérations de l'utilisateur), on emploie niche_storage : pas de booléen,
+         * et sizeof(optional_stack<T>) == sizeof(T).
+         *
+         * Sinon, si T est trivialement copiable et destructible, trivial_storage range
+         * la valeur dans une union : l'optional_stack est alors utilisable dans les
+         * expressions constantes (fabriques, isPresent, orElse, filter, transform...).
          */
-
-        alignas(alignof(T)) char t[sizeof(T)];
-        /* alignof() retourne l'alignement minimum requis pour le type T
-         * alignas(n) permet de stocker la variable dans la mémoire
-         * à une adresse multiple de n.
-         * alignas employée en conjonction avec alignof permet donc
-         * de stocker une variable avec le bon alignement
-         */
-
-        bool is_empty; // true ssi l'instance est empty
+        typename compact_storage<T>::type s;
 
         // Constructeur pour l'optional_stack non vide
         // Privé car l'on ne souhaite pas construire d'optionnel directement,
-        explicit optional_stack(const T &t);
+        constexpr explicit optional_stack(const T &t);
 
-        // Constructeur pour l'optional_stack vide, privé donc
-        explicit optional_stack();
+        // Construit la valeur directement dans le stockage à partir de args
+        template<class... Args>
+        constexpr explicit optional_stack(in_place_t, Args &&... args);
 
-        // Référence statique vers l'optional_stack vide
-        const static optional_stack<T> &none;
+        // Constructeur pour l'optional_stack vide, privé donc
+        constexpr explicit optional_stack();
 
-        /* Retourne le tableau de char sous forme
-         * d'un pointeur vers un objet de type T.
+        /* Retourne un pointeur vers la valeur stockée
+         * (nullptr si l'instance est empty).
          */
-        const T *pointer_to_t() const;
+        constexpr const T *pointer_to_t() const;
 
-    public:
-        /* On souhaite l'un des opérateurs suivants donc tous ("Rule of three") :
-         * - un destructeur
-         * - un constructeur par copie
-         * - un opérateur d'affectation
-         */
-        ~optional_stack();
+        template<class F>
+        constexpr typename optional_stack_transform<F, T>::type transform_impl(F &&f, std::false_type) const;
 
-        optional_stack(const optional_stack<T> &other);
+        template<class F>
+        constexpr typename optional_stack_transform<F, T>::type transform_impl(F &&f, std::true_type) const;
 
-        optional_stack<T> &operator=(const optional_stack<T> &other);
+    public:
+        /* Le destructeur, la construction et l'affectation par copie et par déplacement
+         * ("Rule of five") sont ceux du stockage : ceux générés par défaut suffisent.
+         * Le déplacement est noexcept dès que celui de T l'est.
+         *
+         * Les fonctions marquées constexpr ne sont évaluables à la compilation que si
+         * le stockage l'est (trivial_storage, niche_storage des pointeurs et énumérations) ;
+         * pour les autres types elles restent de simples fonctions inline.
+         * En C++11, l'appelable passé à filter/transform doit alors être un foncteur
+         * dont l'opérateur () est constexpr (les lambdas ne le sont qu'à partir de C++17).
+         */
 
         /* Surcharge de l'opérateur bool() pour convertir l'optional_stack
          * en une valeur de vérité.
          * Retourne la valeur retournée par isPresent(),
          * ie. true ssi il est différent de empty(). */
-        explicit operator bool() const;
+        constexpr explicit operator bool() const;
 
         /* Fabriques de valeurs optionnelles */
-        static optional_stack<T> of(T &t);
+        static constexpr optional_stack<T> of(const T &t);
 
-        static optional_stack<T> ofNullable(T *t);
+        static constexpr optional_stack<T> ofNullable(T *t);
 
-        /* Retourne une référence vers l'optional_stack empty */
-        static const optional_stack<T> &empty();
+        /* Retourne l'optional_stack vide (par valeur : il ne contient qu'un booléen
+         * ou une sentinelle, et reste ainsi utilisable dans une expression constante) */
+        static constexpr optional_stack<T> empty();
 
-        bool isEmpty() const;
+        constexpr bool isEmpty() const;
 
-        bool isPresent() const;
+        constexpr bool isPresent() const;
 
-        T orElseThrow() const;
+        /* Sur un optional_stack temporaire (ou std::move(o)), orElseThrow et *
+         * déplacent la valeur au lieu de la copier.
+         */
+        constexpr T orElseThrow() const &;
+
+        T orElseThrow() &&;
 
-        T orElse(T &other) const;
+        constexpr T orElse(const T &other) const;
 
         /*
          * Implémentation des opérateurs sur pointeurs
          */
-        const T &operator*();
+        constexpr const T &operator*() const &;
+
+        T operator*() &&;
 
         const T *operator->();
 
@@ -105,9 +158,32 @@ namespace lib {
         template<class U>
         optional_stack<U> map(U *(&f)(T));
 
-        optional_stack<T> filter(std::function<bool(T)> predicate);
+        optional_stack<T> filter(std::function<bool(T)> predicate) const;
 
-        optional_stack<T> filter(bool (&predicate)(T));
+        optional_stack<T> filter(bool (&predicate)(T)) const;
+
+        /* Versions génériques de map et filter : f peut être n'importe quel appelable
+         * (lambda avec ou sans capture, foncteur, pointeur de fonction).
+         * Contrairement à std::function il n'y a ni effacement de type ni allocation,
+         * l'appel peut donc être inliné. La valeur est passée par référence constante.
+         */
+        template<class F>
+        optional_stack<typename pointee_result<F, T>::type> map(F &&f);
+
+        template<class F>
+        constexpr optional_stack<T> filter(F &&predicate) const &;
+
+        // Sur un optional_stack temporaire, filter retourne *this déplacé au lieu d'une copie
+        template<class F>
+        optional_stack<T> filter(F &&predicate) &&;
+
+        /* Comme map, mais f retourne directement une valeur U (et non plus un U* alloué)
+         * construite dans l'optional_stack retourné : aucune allocation.
+         * Si f retourne un optional_stack<U>, celui-ci est retourné tel quel ("flat map").
+         * C'est la forme de map utilisable dans une expression constante.
+         */
+        template<class F>
+        constexpr typename optional_stack_transform<F, T>::type transform(F &&f) const;
     };
 
     template<class T>
@@ -140,7 +216,7 @@ namespace lib {
 
     template<class T>
     optional_stack<T>
-    optional_stack<T>::filter(std::function<bool(T)> predicate) {
+    optional_stack<T>::filter(std::function<bool(T)> predicate) const {
         if (isEmpty()) {
             return optional_stack<T>::empty();
         }
@@ -152,7 +228,7 @@ namespace lib {
 
     template<class T>
     optional_stack<T>
-    optional_stack<T>::filter(bool(&predicate)(T)) {
+    optional_stack<T>::filter(bool(&predicate)(T)) const {
         if (isEmpty()) {
             return optional_stack<T>::empty();
         }
@@ -163,113 +239,148 @@ namespace lib {
     }
 
     template<class T>
-    optional_stack<T>::operator bool() const {
-        return isPresent();
+    template<class F>
+    optional_stack<typename pointee_result<F, T>::type> optional_stack<T>::map(F &&f) {
+        typedef typename pointee_result<F, T>::type U;
+        if (isEmpty()) {
+            return optional_stack<U>::empty();
+        }
+        U *u = std::forward<F>(f)(*pointer_to_t());
+        optional_stack<U> o = optional_stack<U>::ofNullable(u);
+        if (u != nullptr) {
+            delete u;
+        }
+        return o;
     }
 
+    /* Les fonctions constexpr sont écrites sous la forme d'un unique return
+     * (seule forme autorisée en C++11).
+     */
+
     template<class T>
-    T optional_stack<T>::orElse(T &other) const {
-        if (isEmpty()) {
-            return other;
-        }
-        return *pointer_to_t();
+    template<class F>
+    constexpr optional_stack<T> optional_stack<T>::filter(F &&predicate) const &{
+        return isEmpty() || !std::forward<F>(predicate)(*pointer_to_t()) ? optional_stack<T>::empty() : *this;
     }
 
     template<class T>
-    T optional_stack<T>::orElseThrow() const {
-        if (isEmpty()) {
-            throw std::runtime_error("Cannot get value of None type");
+    template<class F>
+    optional_stack<T> optional_stack<T>::filter(F &&predicate) &&{
+        if (isEmpty() || !std::forward<F>(predicate)(*pointer_to_t())) {
+            return optional_stack<T>::empty();
         }
-        return *pointer_to_t();
+        return std::move(*this);
     }
 
     template<class T>
-    bool optional_stack<T>::isEmpty() const {
-        return is_empty;
+    template<class F>
+    constexpr typename optional_stack_transform<F, T>::type optional_stack<T>::transform(F &&f) const {
+        return transform_impl(std::forward<F>(f),
+                              is_optional_type<typename optional_stack_transform<F, T>::value_type>());
     }
 
     template<class T>
-    optional_stack<T>::~optional_stack() {
-        // Appel du destructeur de T,
-        // on supprime l'objet pointé par pointer_to_t.
-        pointer_to_t()->~T();
+    template<class F>
+    constexpr typename optional_stack_transform<F, T>::type
+    optional_stack<T>::transform_impl(F &&f, std::false_type) const {
+        return isEmpty()
+               ? optional_stack_transform<F, T>::type::empty()
+               : typename optional_stack_transform<F, T>::type(in_place, std::forward<F>(f)(*pointer_to_t()));
     }
 
     template<class T>
-    optional_stack<T> optional_stack<T>::of(T &t) {
-        return optional_stack<T>(t);
+    template<class F>
+    constexpr typename optional_stack_transform<F, T>::type
+    optional_stack<T>::transform_impl(F &&f, std::true_type) const {
+        return isEmpty() ? optional_stack_transform<F, T>::type::empty() : std::forward<F>(f)(*pointer_to_t());
     }
 
     template<class T>
-    const optional_stack<T> &optional_stack<T>::empty() {
-        return none;
+    constexpr optional_stack<T>::operator bool() const {
+        return isPresent();
     }
 
     template<class T>
-    optional_stack<T> optional_stack<T>::ofNullable(T *t) {
-        if (t == nullptr) {
-            return optional_stack<T>::empty();
-        }
-        return optional_stack<T>(*t);
+    constexpr T optional_stack<T>::orElse(const T &other) const {
+        return isEmpty() ? other : *pointer_to_t();
     }
 
     template<class T>
-    bool optional_stack<T>::isPresent() const {
-        return !isEmpty();
+    constexpr T optional_stack<T>::orElseThrow() const &{
+        return isEmpty() ? raise_runtime_error<T>("Cannot get value of None type") : *pointer_to_t();
     }
 
     template<class T>
-    const T &optional_stack<T>::operator*() {
-        return pointer_to_t() == nullptr ? throw std::runtime_error("Cannot dereference nullptr") : *pointer_to_t();
+    T optional_stack<T>::orElseThrow() &&{
+        if (isEmpty()) {
+            raise_runtime_error<void>("Cannot get value of None type");
+        }
+        return std::move(*s.getMutable());
     }
 
     template<class T>
-    const T *optional_stack<T>::operator->() {
-        return pointer_to_t();
+    constexpr bool optional_stack<T>::isEmpty() const {
+        return s.isEmpty();
     }
 
     template<class T>
-    const T *optional_stack<T>::pointer_to_t() const {
-        /* C++ style cast, vérifie le cast à la compilation
-         * contrairement au C-style cast : (T*) t.
-         */
-        return reinterpret_cast<const T *>(t);
+    constexpr optional_stack<T> optional_stack<T>::of(const T &t) {
+        return optional_stack<T>(t);
     }
 
     template<class T>
-    optional_stack<T>::optional_stack(const T &t) : is_empty{false} {
-        /* Syntaxe "placement new" :
-         * copie le pointeur t de type T
-         * dans le tableau this->t.
-         * En C on emploie plutôt memcpy mais c'est une 
-         * très mauvaise idée de faire de même en C++.
-         */
-        new(this->t) T(t);
+    constexpr optional_stack<T> optional_stack<T>::empty() {
+        return optional_stack<T>();
     }
 
     template<class T>
-    optional_stack<T>::optional_stack() : is_empty{true} {}
+    constexpr optional_stack<T> optional_stack<T>::ofNullable(T *t) {
+        return t == nullptr ? optional_stack<T>::empty() : optional_stack<T>(*t);
+    }
+
+    template<class T>
+    constexpr bool optional_stack<T>::isPresent() const {
+        return !isEmpty();
+    }
 
     template<class T>
-    optional_stack<T>::optional_stack(const optional_stack<T> &other)
-            : is_empty{other.is_empty} {
-        // on copie le contenu du pointeur de other dans this->t
-        new(this->t) T(*other.pointer_to_t());
+    constexpr const T &optional_stack<T>::operator*() const &{
+        return pointer_to_t() == nullptr ? raise_runtime_error<const T &>("Cannot dereference nullptr")
+                                         : *pointer_to_t();
     }
 
     template<class T>
-    optional_stack<T> &optional_stack<T>::operator=(const optional_stack<T> &other) {
-        // on copie le contenu de other dans l'instance courante
-        if (&other != this) {
-            is_empty = other.is_empty;
-            new(this->t) T(*other.t);
+    T optional_stack<T>::operator*() &&{
+        if (isEmpty()) {
+            raise_runtime_error<void>("Cannot dereference nullptr");
         }
-        return *this;
+        return std::move(*s.getMutable());
     }
 
+    template<class T>
+    const T *optional_stack<T>::operator->() {
+        return pointer_to_t();
+    }
 
     template<class T>
-    const optional_stack<T> &optional_stack<T>::none = optional_stack<T>();
+    constexpr const T *optional_stack<T>::pointer_to_t() const {
+        return s.get();
+    }
+
+    template<class T>
+    constexpr optional_stack<T>::optional_stack(const T &t) : s{in_place, t} {}
+
+    template<class T>
+    template<class... Args>
+    constexpr optional_stack<T>::optional_stack(in_place_t, Args &&... args)
+            : s{in_place, std::forward<Args>(args)...} {}
+
+    template<class T>
+    constexpr optional_stack<T>::optional_stack() : s{} {}
+
+    static_assert(std::is_trivially_copyable<optional_stack<int> >::value, "optional_stack<int> trivialement copiable");
+    static_assert(std::is_trivially_copyable<optional_stack<double> >::value,
+                  "optional_stack<double> trivialement copiable");
 
 }
 
@@ -0,0 +1,673 @@
+#ifndef OPTIONAL_STORAGE_HPP
+#define OPTIONAL_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "optional_allocation.hpp"
+#include "optional_config.hpp"
+
+/* Politiques de stockage de lib::optional.
+ *
+ * Une politique de stockage décide de l'endroit où vit la valeur encapsulée :
+ * - heap_storage : sur le tas (l'implémentation demandée dans le TP), la mémoire étant
+ *   fournie par une politique d'allocation (cf. optional_allocation.hpp), new/delete par défaut
+ * - inline_storage : dans l'instance d'optional elle-même, sans aucune allocation
+ * - niche_storage : dans l'instance elle-même, l'absence de valeur étant codée par une
+ *   valeur sentinelle de T (cf. niche_traits) au lieu d'un booléen
+ * - trivial_storage : dans l'instance elle-même, au moyen d'une union ; réservé aux types
+ *   trivialement copiables et destructibles, utilisable dans les expressions constantes
+ *
+ * Toutes les politiques exposent la même interface :
+ * - un constructeur par défaut qui construit un stockage vide
+ * - un constructeur (in_place, args...) qui construit la valeur sur place
+ * - la construction/affectation par copie et par déplacement, et le destructeur
+ * - isEmpty(), get() (nullptr si vide) et getMutable()
+ * - rebind<U> : la même politique pour un autre type U (utilisé par transform)
+ */
+
+namespace lib {
+
+    // Étiquette pour demander la construction de la valeur directement dans le stockage
+    struct in_place_t {
+    };
+
+    constexpr in_place_t in_place = in_place_t();
+
+    template<class T, template<class> class Allocation = new_allocation>
+    class heap_storage {
+    private:
+        T *t;
+
+        // Équivalents de new T(args...) et delete t, la mémoire venant de Allocation<T>
+        template<class... Args>
+        static T *create(Args &&... args);
+
+        static void destroy(T *t);
+
+    public:
+        template<class U>
+        using rebind = heap_storage<U, Allocation>;
+
+        heap_storage() noexcept;
+
+        template<class... Args>
+        explicit heap_storage(in_place_t, Args &&... args);
+
+        heap_storage(const heap_storage<T, Allocation> &other);
+
+        heap_storage<T, Allocation> &operator=(const heap_storage<T, Allocation> &other);
+
+        // Le déplacement transfère simplement le pointeur
+        heap_storage(heap_storage<T, Allocation> &&other) noexcept;
+
+        heap_storage<T, Allocation> &operator=(heap_storage<T, Allocation> &&other) noexcept;
+
+        ~heap_storage();
+
+        bool isEmpty() const;
+
+        const T *get() const;
+
+        T *getMutable();
+    };
+
+    /* Données d'inline_storage, sans copie, déplacement ni destructeur déclarés :
+     * pour un T trivialement copiable, copier les octets du tableau copie la valeur,
+     * inline_storage l'est donc aussi (std::vector peut alors le déplacer par memmove
+     * et un tableau d'optionals peut être copié par memcpy).
+     * Pour les autres types, la spécialisation <T, false> ajoute les opérations qui
+     * construisent et détruisent la valeur.
+     */
+    template<class T, bool Trivial = std::is_trivially_copyable<T>::value>
+    class inline_storage_base {
+    protected:
+        /* Même principe que optional_stack : on réserve dans l'instance
+         * un tableau de char de la taille de T, aligné comme T,
+         * et l'on y construit la valeur avec un "placement new".
+         */
+        alignas(alignof(T)) char t[sizeof(T)];
+
+        bool is_empty; // true ssi aucune valeur n'est construite dans t
+
+        inline_storage_base() noexcept;
+
+        T *pointer_to_t();
+
+        const T *pointer_to_t() const;
+    };
+
+    template<class T>
+    class inline_storage_base<T, false> : protected inline_storage_base<T, true> {
+    protected:
+        inline_storage_base() noexcept;
+
+        inline_storage_base(const inline_storage_base<T, false> &other);
+
+        inline_storage_base<T, false> &operator=(const inline_storage_base<T, false> &other);
+
+        // Le déplacement déplace la valeur de other (qui reste non vide, dans un état "moved-from")
+        inline_storage_base(inline_storage_base<T, false> &&other)
+        noexcept(std::is_nothrow_move_constructible<T>::value);
+
+        inline_storage_base<T, false> &operator=(inline_storage_base<T, false> &&other)
+        noexcept(std::is_nothrow_move_constructible<T>::value);
+
+        ~inline_storage_base();
+    };
+
+    /* Copie, déplacement et destruction sont ceux de inline_storage_base :
+     * triviaux si et seulement si T est trivialement copiable.
+     */
+    template<class T>
+    class inline_storage : private inline_storage_base<T> {
+    public:
+        template<class U>
+        using rebind = inline_storage<U>;
+
+        inline_storage() noexcept;
+
+        template<class... Args>
+        explicit inline_storage(in_place_t, Args &&... args);
+
+        bool isEmpty() const;
+
+        const T *get() const;
+
+        T *getMutable();
+    };
+
+    /* Variante d'inline_storage pour les types trivialement copiables et destructibles :
+     * la valeur est membre d'une union au lieu d'être construite dans un tableau de char,
+     * sans placement new ni reinterpret_cast. Tout est constexpr, un optional_stack de
+     * ces types peut donc être calculé à la compilation (ex : tables de correspondance).
+     * Copie, déplacement et destruction sont ceux générés par défaut, donc triviaux.
+     */
+    template<class T>
+    class trivial_storage {
+    private:
+        static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                      "trivial_storage est réservé aux types trivialement copiables et destructibles");
+
+        union {
+            char none; // membre actif si vide
+            T t;
+        };
+
+        bool is_empty;
+
+    public:
+        template<class U>
+        using rebind = trivial_storage<U>;
+
+        constexpr trivial_storage() noexcept;
+
+        template<class... Args>
+        constexpr explicit trivial_storage(in_place_t, Args &&... args);
+
+        constexpr bool isEmpty() const;
+
+        constexpr const T *get() const;
+
+        T *getMutable();
+    };
+
+    /* niche_traits<T> permet à un type de déclarer une valeur sentinelle ("niche"),
+     * jamais utilisée comme valeur légitime, qui représente l'optional vide.
+     * L'optional n'a alors pas besoin d'un booléen : sizeof(optional) == sizeof(T).
+     *
+     * Un type avec niche spécialise niche_traits et fournit :
+     * - has_niche = true
+     * - static T none() : la valeur sentinelle
+     * - static bool isNone(const T &t) : true ssi t est la valeur sentinelle
+     *
+     * Attention : une valeur égale à la sentinelle est indiscernable de l'absence de valeur
+     * (ex : optional_stack<int *>::of(p) avec p == nullptr est vide).
+     */
+    template<class T>
+    struct niche_traits {
+        static constexpr bool has_niche = false;
+    };
+
+    // Pointeurs : nullptr
+    template<class T>
+    struct niche_traits<T *> {
+        static constexpr bool has_niche = true;
+
+        static constexpr T *none() {
+            return nullptr;
+        }
+
+        static constexpr bool isNone(T *t) {
+            return t == nullptr;
+        }
+    };
+
+    /* double : un NaN particulier ("NaN-boxing"). Les autres NaN, dont celui
+     * de std::numeric_limits<double>::quiet_NaN(), restent des valeurs légitimes.
+     * On compare les bits (et non les valeurs, un NaN n'étant égal à rien) :
+     * avec __builtin_bit_cast, none et isNone sont constexpr (cf. optional_config.hpp).
+     */
+    template<>
+    struct niche_traits<double> {
+        static constexpr bool has_niche = true;
+
+        static constexpr std::uint64_t none_bits = 0x7FF8DEADBEEF0001ull;
+
+#if LIB_OPTIONAL_CONSTEXPR_BIT_CAST
+        static constexpr double none() {
+            return __builtin_bit_cast(double, std::uint64_t(none_bits));
+        }
+
+        static constexpr bool isNone(double d) {
+            return __builtin_bit_cast(std::uint64_t, d) == none_bits;
+        }
+#else
+        static double none() {
+            std::uint64_t bits = none_bits; // copie locale : pas de définition hors classe en C++11
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+
+        static bool isNone(double d) {
+            std::uint64_t bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            return bits == none_bits;
+        }
+#endif
+    };
+
+    template<>
+    struct niche_traits<float> {
+        static constexpr bool has_niche = true;
+
+        static constexpr std::uint32_t none_bits = 0x7FC0BEEFu;
+
+#if LIB_OPTIONAL_CONSTEXPR_BIT_CAST
+        static constexpr float none() {
+            return __builtin_bit_cast(float, std::uint32_t(none_bits));
+        }
+
+        static constexpr bool isNone(float f) {
+            return __builtin_bit_cast(std::uint32_t, f) == none_bits;
+        }
+#else
+        static float none() {
+            std::uint32_t bits = none_bits;
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+
+        static bool isNone(float f) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return bits == none_bits;
+        }
+#endif
+    };
+
+    /* Énumérations de l'utilisateur : il suffit d'hériter de enum_niche_traits
+     * en donnant l'énumérateur qui ne représente aucune valeur valide, ex :
+     *
+     *   enum class Opcode : std::uint8_t { Add, Sub, Invalid };
+     *   namespace lib {
+     *       template<> struct niche_traits<Opcode> : enum_niche_traits<Opcode, Opcode::Invalid> {};
+     *   }
+     */
+    template<class E, E Sentinel>
+    struct enum_niche_traits {
+        static_assert(std::is_enum<E>::value, "enum_niche_traits est réservé aux énumérations");
+
+        static constexpr bool has_niche = true;
+
+        static constexpr E none() {
+            return Sentinel;
+        }
+
+        static constexpr bool isNone(E e) {
+            return e == Sentinel;
+        }
+    };
+
+    template<class T>
+    class niche_storage {
+    private:
+        static_assert(niche_traits<T>::has_niche, "niche_storage nécessite une spécialisation de niche_traits");
+
+        T t; // la valeur, ou niche_traits<T>::none() si vide
+
+    public:
+        template<class U>
+        using rebind = niche_storage<U>;
+
+        constexpr niche_storage() noexcept;
+
+        template<class... Args>
+        constexpr explicit niche_storage(in_place_t, Args &&... args);
+
+        // constexpr si niche_traits<T>::isNone l'est (pointeurs, énumérations, double et float
+        // avec __builtin_bit_cast)
+        constexpr bool isEmpty() const;
+
+        constexpr const T *get() const;
+
+        T *getMutable();
+    };
+
+    /* Stockage de optional<T &> : un simple pointeur vers l'objet référencé,
+     * que la copie et l'affectation recopient (l'optional est "re-liable").
+     * La valeur n'est jamais copiée ni détruite.
+     */
+    template<class T>
+    class reference_storage {
+    private:
+        T *t;
+
+    public:
+        template<class U>
+        using rebind = reference_storage<U>;
+
+        reference_storage() noexcept;
+
+        reference_storage(in_place_t, T &t) noexcept;
+
+        bool isEmpty() const;
+
+        // Un optional<T &> constant référence tout de même un T modifiable
+        T *get() const;
+
+        T *getMutable() const;
+    };
+
+    /* Stockage le plus compact disponible pour T : la niche si T en déclare une,
+     * sinon l'union de trivial_storage si T est trivialement copiable et destructible.
+     * Sans __builtin_bit_cast, la niche de double et float n'est pas constexpr :
+     * on leur préfère alors trivial_storage, pour qu'optional_stack reste constexpr.
+     */
+    template<class T>
+    struct compact_storage {
+        typedef typename std::conditional<
+                niche_traits<T>::has_niche && (LIB_OPTIONAL_CONSTEXPR_BIT_CAST || !std::is_floating_point<T>::value),
+                niche_storage<T>,
+                typename std::conditional<
+                        std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                        trivial_storage<T>,
+                        inline_storage<T>
+                >::type
+        >::type type;
+    };
+
+    // Taille maximale (en octets) d'un type stocké par défaut dans l'optional lui-même
+    constexpr std::size_t inline_storage_max_size = 64;
+
+    /* Politique choisie par défaut pour un type T :
+     * les petits types trivialement copiables sont stockés dans l'optional,
+     * les autres sur le tas.
+     * On peut spécialiser default_storage pour changer le choix d'un type donné.
+     */
+    template<class T>
+    struct default_storage {
+        typedef typename std::conditional<
+                std::is_trivially_copyable<T>::value && sizeof(T) <= inline_storage_max_size,
+                inline_storage<T>,
+                heap_storage<T>
+        >::type type;
+    };
+
+    template<class T>
+    struct default_storage<T &> {
+        typedef reference_storage<T> type;
+    };
+
+    // ======================== heap_storage ========================
+
+    template<class T, template<class> class Allocation>
+    template<class... Args>
+    T *heap_storage<T, Allocation>::create(Args &&... args) {
+        void *p = Allocation<T>::allocate();
+#if LIB_OPTIONAL_EXCEPTIONS
+        try {
+            return new(p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            // Comme new T(args...) : la mémoire est rendue si le constructeur lève une exception
+            Allocation<T>::deallocate(p);
+            throw;
+        }
+#else
+        return new(p) T(std::forward<Args>(args)...);
+#endif
+    }
+
+    template<class T, template<class> class Allocation>
+    void heap_storage<T, Allocation>::destroy(T *t) {
+        t->~T();
+        Allocation<T>::deallocate(t);
+    }
+
+    template<class T, template<class> class Allocation>
+    heap_storage<T, Allocation>::heap_storage() noexcept : t{nullptr} {}
+
+    template<class T, template<class> class Allocation>
+    template<class... Args>
+    heap_storage<T, Allocation>::heap_storage(in_place_t, Args &&... args)
+            : t{create(std::forward<Args>(args)...)} {}
+
+    template<class T, template<class> class Allocation>
+    heap_storage<T, Allocation>::heap_storage(const heap_storage<T, Allocation> &other)
+    /* On ne déréférence pas un pointeur nul! Et l'on copie l'objet pointé par other.t
+     * afin de ne pas se retrouver avec deux pointeurs pointant vers le même objet
+     * et obtenir un double free lorsque le destructeur de this et other est appelé.
+     */
+            : t{other.t == nullptr ? nullptr : create(*other.t)} {}
+
+    template<class T, template<class> class Allocation>
+    heap_storage<T, Allocation> &heap_storage<T, Allocation>::operator=(const heap_storage<T, Allocation> &other) {
+        if (&other != this) {
+            /* On supprime l'objet uniquement pointé par t avant de le faire pointer
+             * vers autre chose pour éviter une fuite de mémoire.
+             */
+            if (t != nullptr) {
+                destroy(t);
+            }
+            // Copie ou non de l'objet pointé par le pointeur de l'autre instance other.
+            if (other.t != nullptr) {
+                t = create(*other.t);
+            } else {
+                t = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    template<class T, template<class> class Allocation>
+    heap_storage<T, Allocation>::heap_storage(heap_storage<T, Allocation> &&other) noexcept : t{other.t} {
+        other.t = nullptr;
+    }
+
+    template<class T, template<class> class Allocation>
+    heap_storage<T, Allocation> &heap_storage<T, Allocation>::operator=(heap_storage<T, Allocation> &&other) noexcept {
+        if (&other != this) {
+            if (t != nullptr) {
+                destroy(t);
+            }
+            t = other.t;
+            other.t = nullptr;
+        }
+        return *this;
+    }
+
+    template<class T, template<class> class Allocation>
+    heap_storage<T, Allocation>::~heap_storage() {
+        if (t != nullptr) {
+            destroy(t);
+        }
+    }
+
+    template<class T, template<class> class Allocation>
+    bool heap_storage<T, Allocation>::isEmpty() const {
+        return t == nullptr;
+    }
+
+    template<class T, template<class> class Allocation>
+    const T *heap_storage<T, Allocation>::get() const {
+        return t;
+    }
+
+    template<class T, template<class> class Allocation>
+    T *heap_storage<T, Allocation>::getMutable() {
+        return t;
+    }
+
+    // ======================= inline_storage =======================
+
+    template<class T, bool Trivial>
+    inline_storage_base<T, Trivial>::inline_storage_base() noexcept : is_empty{true} {}
+
+    template<class T, bool Trivial>
+    T *inline_storage_base<T, Trivial>::pointer_to_t() {
+        return reinterpret_cast<T *>(t);
+    }
+
+    template<class T, bool Trivial>
+    const T *inline_storage_base<T, Trivial>::pointer_to_t() const {
+        return reinterpret_cast<const T *>(t);
+    }
+
+    template<class T>
+    inline_storage_base<T, false>::inline_storage_base() noexcept : inline_storage_base<T, true>() {}
+
+    template<class T>
+    inline_storage_base<T, false>::inline_storage_base(const inline_storage_base<T, false> &other)
+            : inline_storage_base<T, true>() {
+        // On ne copie la valeur de other que si elle a été construite
+        if (!other.is_empty) {
+            new(this->t) T(*other.pointer_to_t());
+            this->is_empty = false;
+        }
+    }
+
+    template<class T>
+    inline_storage_base<T, false> &
+    inline_storage_base<T, false>::operator=(const inline_storage_base<T, false> &other) {
+        if (&other != this) {
+            // On détruit l'ancienne valeur avant d'en construire une nouvelle à sa place
+            if (!this->is_empty) {
+                this->pointer_to_t()->~T();
+                this->is_empty = true;
+            }
+            if (!other.is_empty) {
+                new(this->t) T(*other.pointer_to_t());
+                this->is_empty = false;
+            }
+        }
+        return *this;
+    }
+
+    template<class T>
+    inline_storage_base<T, false>::inline_storage_base(inline_storage_base<T, false> &&other)
+    noexcept(std::is_nothrow_move_constructible<T>::value) : inline_storage_base<T, true>() {
+        if (!other.is_empty) {
+            new(this->t) T(std::move(*other.pointer_to_t()));
+            this->is_empty = false;
+        }
+    }
+
+    template<class T>
+    inline_storage_base<T, false> &inline_storage_base<T, false>::operator=(inline_storage_base<T, false> &&other)
+    noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (&other != this) {
+            if (!this->is_empty) {
+                this->pointer_to_t()->~T();
+                this->is_empty = true;
+            }
+            if (!other.is_empty) {
+                new(this->t) T(std::move(*other.pointer_to_t()));
+                this->is_empty = false;
+            }
+        }
+        return *this;
+    }
+
+    template<class T>
+    inline_storage_base<T, false>::~inline_storage_base() {
+        // Appel du destructeur de T uniquement si une valeur a été construite
+        if (!this->is_empty) {
+            this->pointer_to_t()->~T();
+        }
+    }
+
+    template<class T>
+    inline_storage<T>::inline_storage() noexcept : inline_storage_base<T>() {}
+
+    template<class T>
+    template<class... Args>
+    inline_storage<T>::inline_storage(in_place_t, Args &&... args) : inline_storage_base<T>() {
+        new(this->t) T(std::forward<Args>(args)...);
+        this->is_empty = false;
+    }
+
+    template<class T>
+    bool inline_storage<T>::isEmpty() const {
+        return this->is_empty;
+    }
+
+    template<class T>
+    const T *inline_storage<T>::get() const {
+        return this->is_empty ? nullptr : this->pointer_to_t();
+    }
+
+    template<class T>
+    T *inline_storage<T>::getMutable() {
+        return this->is_empty ? nullptr : this->pointer_to_t();
+    }
+
+    // ======================= trivial_storage ======================
+
+    template<class T>
+    constexpr trivial_storage<T>::trivial_storage() noexcept : none{}, is_empty{true} {}
+
+    template<class T>
+    template<class... Args>
+    constexpr trivial_storage<T>::trivial_storage(in_place_t, Args &&... args)
+            : t(std::forward<Args>(args)...), is_empty{false} {}
+
+    template<class T>
+    constexpr bool trivial_storage<T>::isEmpty() const {
+        return is_empty;
+    }
+
+    template<class T>
+    constexpr const T *trivial_storage<T>::get() const {
+        return is_empty ? nullptr : &t;
+    }
+
+    template<class T>
+    T *trivial_storage<T>::getMutable() {
+        return is_empty ? nullptr : &t;
+    }
+
+    // ====================== reference_storage =====================
+
+    template<class T>
+    reference_storage<T>::reference_storage() noexcept : t{nullptr} {}
+
+    template<class T>
+    reference_storage<T>::reference_storage(in_place_t, T &t) noexcept : t{&t} {}
+
+    template<class T>
+    bool reference_storage<T>::isEmpty() const {
+        return t == nullptr;
+    }
+
+    template<class T>
+    T *reference_storage<T>::get() const {
+        return t;
+    }
+
+    template<class T>
+    T *reference_storage<T>::getMutable() const {
+        return t;
+    }
+
+    // ======================== niche_storage =======================
+
+    /* Copie, déplacement et destruction sont ceux de T :
+     * pas de booléen à maintenir, la sentinelle est une valeur comme une autre.
+     */
+
+    template<class T>
+    constexpr niche_storage<T>::niche_storage() noexcept : t(niche_traits<T>::none()) {}
+
+    template<class T>
+    template<class... Args>
+    constexpr niche_storage<T>::niche_storage(in_place_t, Args &&... args) : t(std::forward<Args>(args)...) {}
+
+    template<class T>
+    constexpr bool niche_storage<T>::isEmpty() const {
+        return niche_traits<T>::isNone(t);
+    }
+
+    template<class T>
+    constexpr const T *niche_storage<T>::get() const {
+        return isEmpty() ? nullptr : &t;
+    }
+
+    template<class T>
+    T *niche_storage<T>::getMutable() {
+        return isEmpty() ? nullptr : &t;
+    }
+
+    // Les stockages dans l'instance propagent la trivialité de T
+    static_assert(std::is_trivially_copyable<inline_storage<int> >::value, "inline_storage<int> trivialement copiable");
+    static_assert(std::is_trivially_copyable<trivial_storage<int> >::value, "trivial_storage<int> trivialement copiable");
+    static_assert(std::is_trivially_copyable<niche_storage<int *> >::value, "niche_storage<int *> trivialement copiable");
+
+}
+
+
+#endif
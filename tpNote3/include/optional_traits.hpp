@@ -0,0 +1,40 @@
+#ifndef OPTIONAL_TRAITS_HPP
+#define OPTIONAL_TRAITS_HPP
+
+#include <type_traits>
+
+// Traits partagés par les différentes implémentations d'optional
+
+namespace lib {
+
+    /* Pour un appelable F retournant un pointeur U* lorsqu'on l'appelle avec
+     * un const T &, pointee_result<F, T>::type est U.
+     * Utilisé pour déduire le type de retour des versions génériques de map.
+     */
+    template<class F, class T>
+    struct pointee_result {
+        typedef typename std::result_of<F(const T &)>::type pointer;
+
+        static_assert(std::is_pointer<pointer>::value, "map attend une fonction retournant un pointeur");
+
+        typedef typename std::remove_pointer<pointer>::type type;
+    };
+
+    /* true ssi R est lui-même un type optionnel : transform aplatit alors le résultat
+     * ("flat map") au lieu de construire un optionnel d'optionnel.
+     * Spécialisé dans chacun des fichiers définissant un type optionnel.
+     */
+    template<class R>
+    struct is_optional_type : std::false_type {
+    };
+
+    // Type (sans référence ni const) retourné par f(const T &)
+    template<class F, class T>
+    struct value_result {
+        typedef typename std::decay<typename std::result_of<F(const T &)>::type>::type type;
+    };
+
+}
+
+
+#endif
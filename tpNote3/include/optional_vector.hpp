@@ -0,0 +1,342 @@
+#ifndef OPTIONAL_VECTOR_HPP
+#define OPTIONAL_VECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* Tableau d'optionnels stocké "en colonnes".
+ *
+ * Plutôt qu'un std::vector<optional_stack<T>> (chaque valeur suivie de son booléen
+ * et du remplissage éventuel), on sépare :
+ * - values : toutes les valeurs, contiguës ;
+ * - validity : un bit de présence par élément, 64 éléments par mot.
+ * Le surcoût de l'absence passe d'un booléen (souvent 8 octets avec l'alignement)
+ * à un bit, et un parcours des valeurs ne traverse plus les indicateurs de présence.
+ *
+ * Une case vide contient T() : T doit être constructible par défaut.
+ * bool est refusé : std::vector<bool> range ses valeurs en bits, sans T * vers lesquels
+ * pointer (data(), optional_view) ; utiliser optional_vector<unsigned char>.
+ */
+
+namespace lib {
+
+    /* Vue optionnelle (non propriétaire) sur une valeur d'un optional_vector :
+     * même interface en lecture que les autres optionnels.
+     * La vue est invalidée par toute modification de l'optional_vector.
+     */
+    template<class T>
+    class optional_view {
+    private:
+        const T *t; // nullptr si la case est vide
+
+    public:
+        explicit optional_view(const T *t);
+
+        explicit operator bool() const;
+
+        bool isEmpty() const;
+
+        bool isPresent() const;
+
+        const T &orElseThrow() const;
+
+        const T &orElse(const T &other) const;
+
+        const T &operator*() const;
+
+        const T *operator->() const;
+    };
+
+    template<class T>
+    class optional_vector {
+    private:
+        static_assert(!std::is_same<T, bool>::value,
+                      "optional_vector<bool> : std::vector<bool> n'a pas de bool *, utiliser unsigned char");
+
+        std::vector<T> values;
+
+        std::vector<std::uint64_t> validity;
+
+        // Ajoute le bit de présence du nouvel élément d'indice values.size() - 1
+        void push_validity(bool present);
+
+    public:
+        /* Itérateur d'entrée : operator* retourne une optional_view par valeur (un proxy),
+         * il n'y a pas de const optional_view<T> & vers lequel pointer comme l'exige
+         * un itérateur "forward".
+         */
+        class const_iterator {
+        private:
+            const optional_vector<T> *v;
+            std::size_t i;
+
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef optional_view<T> value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef void pointer;
+            typedef optional_view<T> reference;
+
+            const_iterator(const optional_vector<T> *v, std::size_t i);
+
+            optional_view<T> operator*() const;
+
+            const_iterator &operator++();
+
+            const_iterator operator++(int);
+
+            bool operator==(const const_iterator &other) const;
+
+            bool operator!=(const const_iterator &other) const;
+        };
+
+        optional_vector();
+
+        void push_back(const T &value);
+
+        void push_back(T &&value);
+
+        template<class... Args>
+        void emplace_back(Args &&... args);
+
+        // Ajoute un élément absent
+        void push_back_empty();
+
+        // Remplace l'élément i par value (présent)
+        void set(std::size_t i, const T &value);
+
+        // Rend l'élément i absent
+        void reset(std::size_t i);
+
+        bool isPresent(std::size_t i) const;
+
+        optional_view<T> operator[](std::size_t i) const;
+
+        std::size_t size() const;
+
+        void reserve(std::size_t n);
+
+        void clear();
+
+        // Nombre d'éléments présents, calculé 64 éléments à la fois (popcount)
+        std::size_t countPresent() const;
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+        /* Accès direct aux colonnes pour les traitements par lots :
+         * size() valeurs, et (size() + 63) / 64 mots de présence
+         * (le bit i % 64 du mot i / 64 vaut 1 ssi l'élément i est présent,
+         * les bits au-delà de size() sont nuls).
+         */
+        T *data();
+
+        const T *data() const;
+
+        std::uint64_t *validityData();
+
+        const std::uint64_t *validityData() const;
+    };
+
+    // ======================== optional_view =======================
+
+    template<class T>
+    optional_view<T>::optional_view(const T *t) : t{t} {}
+
+    template<class T>
+    optional_view<T>::operator bool() const {
+        return isPresent();
+    }
+
+    template<class T>
+    bool optional_view<T>::isEmpty() const {
+        return t == nullptr;
+    }
+
+    template<class T>
+    bool optional_view<T>::isPresent() const {
+        return !isEmpty();
+    }
+
+    template<class T>
+    const T &optional_view<T>::orElseThrow() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot get value of None type");
+        }
+        return *t;
+    }
+
+    template<class T>
+    const T &optional_view<T>::orElse(const T &other) const {
+        return isEmpty() ? other : *t;
+    }
+
+    template<class T>
+    const T &optional_view<T>::operator*() const {
+        return t == nullptr ? throw std::runtime_error("Cannot dereference nullptr") : *t;
+    }
+
+    template<class T>
+    const T *optional_view<T>::operator->() const {
+        return t;
+    }
+
+    // ======================= optional_vector ======================
+
+    template<class T>
+    optional_vector<T>::optional_vector() : values{}, validity{} {}
+
+    template<class T>
+    void optional_vector<T>::push_validity(bool present) {
+        std::size_t i = values.size() - 1;
+        if (i % 64 == 0) {
+            validity.push_back(0);
+        }
+        validity.back() |= static_cast<std::uint64_t>(present) << (i % 64);
+    }
+
+    template<class T>
+    void optional_vector<T>::push_back(const T &value) {
+        values.push_back(value);
+        push_validity(true);
+    }
+
+    template<class T>
+    void optional_vector<T>::push_back(T &&value) {
+        values.push_back(std::move(value));
+        push_validity(true);
+    }
+
+    template<class T>
+    template<class... Args>
+    void optional_vector<T>::emplace_back(Args &&... args) {
+        values.emplace_back(std::forward<Args>(args)...);
+        push_validity(true);
+    }
+
+    template<class T>
+    void optional_vector<T>::push_back_empty() {
+        values.emplace_back();
+        push_validity(false);
+    }
+
+    template<class T>
+    void optional_vector<T>::set(std::size_t i, const T &value) {
+        values[i] = value;
+        validity[i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+
+    template<class T>
+    void optional_vector<T>::reset(std::size_t i) {
+        validity[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+    }
+
+    template<class T>
+    bool optional_vector<T>::isPresent(std::size_t i) const {
+        return (validity[i / 64] >> (i % 64)) & 1;
+    }
+
+    template<class T>
+    optional_view<T> optional_vector<T>::operator[](std::size_t i) const {
+        return optional_view<T>(isPresent(i) ? &values[i] : nullptr);
+    }
+
+    template<class T>
+    std::size_t optional_vector<T>::size() const {
+        return values.size();
+    }
+
+    template<class T>
+    void optional_vector<T>::reserve(std::size_t n) {
+        values.reserve(n);
+        validity.reserve((n + 63) / 64);
+    }
+
+    template<class T>
+    void optional_vector<T>::clear() {
+        values.clear();
+        validity.clear();
+    }
+
+    template<class T>
+    std::size_t optional_vector<T>::countPresent() const {
+        std::size_t count = 0;
+        for (std::uint64_t word : validity) {
+            count += static_cast<std::size_t>(__builtin_popcountll(word));
+        }
+        return count;
+    }
+
+    template<class T>
+    typename optional_vector<T>::const_iterator optional_vector<T>::begin() const {
+        return const_iterator(this, 0);
+    }
+
+    template<class T>
+    typename optional_vector<T>::const_iterator optional_vector<T>::end() const {
+        return const_iterator(this, values.size());
+    }
+
+    template<class T>
+    T *optional_vector<T>::data() {
+        return values.data();
+    }
+
+    template<class T>
+    const T *optional_vector<T>::data() const {
+        return values.data();
+    }
+
+    template<class T>
+    std::uint64_t *optional_vector<T>::validityData() {
+        return validity.data();
+    }
+
+    template<class T>
+    const std::uint64_t *optional_vector<T>::validityData() const {
+        return validity.data();
+    }
+
+    // ======================= const_iterator =======================
+
+    template<class T>
+    optional_vector<T>::const_iterator::const_iterator(const optional_vector<T> *v, std::size_t i) : v{v}, i{i} {}
+
+    template<class T>
+    optional_view<T> optional_vector<T>::const_iterator::operator*() const {
+        return (*v)[i];
+    }
+
+    template<class T>
+    typename optional_vector<T>::const_iterator &optional_vector<T>::const_iterator::operator++() {
+        i++;
+        return *this;
+    }
+
+    template<class T>
+    typename optional_vector<T>::const_iterator optional_vector<T>::const_iterator::operator++(int) {
+        const_iterator before = *this;
+        i++;
+        return before;
+    }
+
+    template<class T>
+    bool optional_vector<T>::const_iterator::operator==(const const_iterator &other) const {
+        return v == other.v && i == other.i;
+    }
+
+    template<class T>
+    bool optional_vector<T>::const_iterator::operator!=(const const_iterator &other) const {
+        return !(*this == other);
+    }
+
+}
+
+
+#endif
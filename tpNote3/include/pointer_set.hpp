@@ -0,0 +1,153 @@
+#ifndef POINTER_SET_HPP
+#define POINTER_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Ensemble de pointeurs à adressage ouvert (sondage linéaire).
+ *
+ * Sert de registre des pointeurs possédés par les instances d'optional
+ * (cf. optional_pt.hpp) : contains, insert et erase sont en O(1) en moyenne,
+ * là où un std::vector demandait un parcours complet à chaque opération.
+ *
+ * nullptr marque une case libre, il ne peut donc pas être inséré.
+ * La suppression décale vers l'arrière les éléments qui suivent la case
+ * libérée ("backward shift deletion") : pas de pierre tombale, les
+ * recherches ne se dégradent pas après de nombreuses suppressions.
+ */
+
+namespace lib {
+
+    template<class T>
+    class pointer_set {
+    private:
+        std::vector<T *> slots; // taille toujours une puissance de 2 (ou 0)
+
+        std::size_t count;
+
+        // Position idéale de p dans slots
+        std::size_t home(T *p) const;
+
+        // Position de p dans slots, ou slots.size() si p est absent
+        std::size_t find(T *p) const;
+
+        void grow();
+
+    public:
+        pointer_set();
+
+        bool contains(T *p) const;
+
+        // Retourne false si p était déjà présent
+        bool insert(T *p);
+
+        // Retourne false si p était absent
+        bool erase(T *p);
+
+        std::size_t size() const;
+    };
+
+    template<class T>
+    pointer_set<T>::pointer_set() : slots{}, count{0} {}
+
+    template<class T>
+    std::size_t pointer_set<T>::home(T *p) const {
+        /* Les bits de poids faible d'un pointeur sont nuls à cause de l'alignement :
+         * on mélange tous les bits (hachage multiplicatif de Fibonacci)
+         * et l'on garde ceux de poids fort.
+         */
+        std::uint64_t h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p));
+        h *= 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> 32) & (slots.size() - 1);
+    }
+
+    template<class T>
+    std::size_t pointer_set<T>::find(T *p) const {
+        if (count == 0) {
+            return slots.size();
+        }
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = home(p);; i = (i + 1) & mask) {
+            if (slots[i] == p) {
+                return i;
+            }
+            if (slots[i] == nullptr) {
+                return slots.size();
+            }
+        }
+    }
+
+    template<class T>
+    void pointer_set<T>::grow() {
+        std::vector<T *> old(slots.empty() ? 16 : 2 * slots.size(), nullptr);
+        old.swap(slots);
+        std::size_t mask = slots.size() - 1;
+        for (T *p : old) {
+            if (p != nullptr) {
+                std::size_t i = home(p);
+                while (slots[i] != nullptr) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = p;
+            }
+        }
+    }
+
+    template<class T>
+    bool pointer_set<T>::contains(T *p) const {
+        return p != nullptr && find(p) != slots.size();
+    }
+
+    template<class T>
+    bool pointer_set<T>::insert(T *p) {
+        // Facteur de charge maximal 1/2 : les séquences de sondage restent courtes
+        if (2 * (count + 1) > slots.size()) {
+            grow();
+        }
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = home(p);
+        while (slots[i] != nullptr) {
+            if (slots[i] == p) {
+                return false;
+            }
+            i = (i + 1) & mask;
+        }
+        slots[i] = p;
+        count++;
+        return true;
+    }
+
+    template<class T>
+    bool pointer_set<T>::erase(T *p) {
+        std::size_t hole = find(p);
+        if (p == nullptr || hole == slots.size()) {
+            return false;
+        }
+        std::size_t mask = slots.size() - 1;
+        /* On remonte dans le trou chaque élément suivant dont la position idéale
+         * ne se situe pas (circulairement) entre le trou et sa position actuelle,
+         * jusqu'à la première case libre.
+         */
+        for (std::size_t j = (hole + 1) & mask; slots[j] != nullptr; j = (j + 1) & mask) {
+            std::size_t h = home(slots[j]);
+            bool stays = hole <= j ? (hole < h && h <= j) : (hole < h || h <= j);
+            if (!stays) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole] = nullptr;
+        count--;
+        return true;
+    }
+
+    template<class T>
+    std::size_t pointer_set<T>::size() const {
+        return count;
+    }
+
+}
+
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef SHARDED_POINTER_SET_HPP
+#define SHARDED_POINTER_SET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "pointer_set.hpp"
+
+/* Version concurrente de pointer_set.
+ *
+ * L'ensemble est découpé en Shards sous-ensembles ("shards") indépendants,
+ * chacun protégé par son propre verrou léger. Le shard d'un pointeur est choisi
+ * à partir de son hachage : deux threads manipulant des pointeurs différents
+ * se bloquent donc rarement mutuellement.
+ *
+ * insert est atomique (test + insertion sous le même verrou) : c'est ce qui
+ * permet de détecter qu'un pointeur est déjà possédé même sous contention.
+ */
+
+namespace lib {
+
+    /* Verrou par attente active : une section critique du registre ne dure
+     * que quelques dizaines de nanosecondes, bien moins qu'un appel système.
+     * On cède tout de même le processeur si l'attente se prolonge
+     * (plus de threads que de coeurs).
+     */
+    class spinlock {
+    private:
+        std::atomic_flag locked = ATOMIC_FLAG_INIT;
+
+    public:
+        void lock();
+
+        void unlock();
+    };
+
+    template<class T, std::size_t Shards = 64>
+    class sharded_pointer_set {
+    private:
+        static_assert((Shards & (Shards - 1)) == 0 && Shards <= 64,
+                      "Shards doit être une puissance de 2 inférieure ou égale à 64");
+
+        // Un shard par ligne de cache pour éviter le faux partage entre verrous voisins
+        struct alignas(64) shard {
+            spinlock lock;
+            pointer_set<T> set;
+        };
+
+        shard shards[Shards];
+
+        shard &shard_of(T *p);
+
+    public:
+        bool contains(T *p);
+
+        // Retourne false si p était déjà présent
+        bool insert(T *p);
+
+        // Retourne false si p était absent
+        bool erase(T *p);
+    };
+
+    inline void spinlock::lock() {
+        for (unsigned spins = 0; locked.test_and_set(std::memory_order_acquire); spins++) {
+            if (spins >= 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    inline void spinlock::unlock() {
+        locked.clear(std::memory_order_release);
+    }
+
+    template<class T, std::size_t Shards>
+    typename sharded_pointer_set<T, Shards>::shard &sharded_pointer_set<T, Shards>::shard_of(T *p) {
+        /* Bits de poids fort du hachage multiplicatif : pointer_set utilise
+         * les bits à partir du 32ème pour la position dans un shard,
+         * les deux choix restent donc indépendants.
+         */
+        std::uint64_t h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(p));
+        h *= 0x9E3779B97F4A7C15ull;
+        return shards[(h >> 58) & (Shards - 1)];
+    }
+
+    template<class T, std::size_t Shards>
+    bool sharded_pointer_set<T, Shards>::contains(T *p) {
+        shard &s = shard_of(p);
+        std::lock_guard<spinlock> guard(s.lock);
+        return s.set.contains(p);
+    }
+
+    template<class T, std::size_t Shards>
+    bool sharded_pointer_set<T, Shards>::insert(T *p) {
+        shard &s = shard_of(p);
+        std::lock_guard<spinlock> guard(s.lock);
+        return s.set.insert(p);
+    }
+
+    template<class T, std::size_t Shards>
+    bool sharded_pointer_set<T, Shards>::erase(T *p) {
+        shard &s = shard_of(p);
+        std::lock_guard<spinlock> guard(s.lock);
+        return s.set.erase(p);
+    }
+
+}
+
+
+#endif
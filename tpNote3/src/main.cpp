@@ -1,6 +1,7 @@
 #include <iostream>
 #include "../include/optional_stack.hpp"
 #include "../include/optional.hpp"
+#include "../include/optional_arena.hpp"
 
 
 int *f(int *x) {
@@ -253,6 +254,33 @@ int main() {
     delete a;
 
 
+    std::cout << "\n\n\nTest des optionnels dans une arène (BONUS)\n\n";
+    lib::arena arena;
+
+    std::cout << "\n\n1: Valeurs dans l'arène, libérées en bloc\n";
+    {
+        lib::arena_scope scope(arena);
+        B b{"in arena"};
+        lib::arena_optional<B> o1 = lib::arena_optional<B>::of(b);
+        lib::arena_optional<B> o2 = lib::arena_optional<B>::ofNullable(&b);
+        lib::arena_optional<B> o3 = o1.filter([](const B &v) { return v.y.size() > 0; });
+        std::cout << o3.orElseThrow().y << "\n";
+        std::cout << (arena.live() == 3) << "\n";
+        std::cout << (arena.used() > 0) << "\n";
+    }
+    std::cout << (arena.used() == 0) << "\n"; // curseur replacé au début de l'arène
+    std::cout << (arena.live() == 0) << "\n";
+
+    std::cout << "\n\n2: Hors de tout scope, repli sur operator new\n";
+    std::cout << (lib::arena::active() == nullptr) << "\n";
+    lib::arena_optional<A> outside = lib::arena_optional<A>::of(a2);
+    std::cout << outside.orElseThrow().x << "\n";
+    std::cout << (arena.used() == 0) << "\n";
+
+    // Optionnels qui s'échappent, scopes emboîtés et libérations depuis un autre thread :
+    // cf. test/test_arena.cpp (lancé par ctest)
+
+
     return 0;
 }
 
@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../include/optional_arena.hpp"
+
+/* Optionnels dans une arène (optional_arena.hpp) : libération en bloc, repli hors scope,
+ * optionnels qui s'échappent de leur scope, scopes emboîtés, et libération depuis un
+ * autre thread. Compilé sous ASan : une région jamais libérée par sa dernière valeur
+ * est signalée comme fuite, une valeur lue après libération de sa région aussi.
+ */
+
+struct B {
+    std::string y;
+
+    explicit B(const std::string &y) : y(y) {}
+};
+
+typedef lib::arena_optional<B> Opt;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("arène : %s incorrect\n", what);
+        failures++;
+    }
+}
+
+// of prend une référence non constante : la valeur est construite dans une variable
+static Opt make(const std::string &y) {
+    B b{y};
+    return Opt::of(b);
+}
+
+// Optionnel créé dans un arena_scope qui lui survit
+static Opt escape(lib::arena &a) {
+    lib::arena_scope scope(a);
+    // Chaîne assez longue pour être allouée sur le tas : ASan verrait une fuite de la valeur
+    B b{std::string(40, 'e')};
+    Opt o = Opt::of(b);
+    Opt tmp = o; // détruite dans le scope
+    return o;
+}
+
+static void bulkRelease(lib::arena &a) {
+    {
+        lib::arena_scope scope(a);
+        B b{"in arena"};
+        Opt o1 = Opt::of(b);
+        Opt o2 = Opt::ofNullable(&b);
+        Opt o3 = o1.filter([](const B &v) { return v.y.size() > 0; });
+        check(o3.orElseThrow().y == "in arena", "valeur dans l'arène");
+        check(a.live() == 3 && a.used() > 0, "valeurs vivantes dans l'arène");
+    }
+    check(a.used() == 0 && a.live() == 0, "libération en bloc");
+
+    check(lib::arena::active() == nullptr, "arène active hors scope");
+    Opt outside = make("outside");
+    check(outside.orElseThrow().y == "outside" && a.used() == 0, "repli sur operator new hors scope");
+}
+
+static void escaping(lib::arena &a) {
+    Opt escaped = escape(a);
+    // La région est abandonnée à l'optionnel : la valeur reste valide
+    check(escaped.orElseThrow().y == std::string(40, 'e'), "valeur qui s'échappe");
+    check(a.used() == 0 && a.live() == 0, "arène repartie d'une région neuve");
+    Opt copy = escaped; // copie hors scope : operator new
+    escaped = Opt::empty(); // dernière valeur : la région est libérée
+    check(copy.orElseThrow().y == std::string(40, 'e'), "copie hors scope");
+
+    // L'arène reste utilisable après un abandon
+    {
+        lib::arena_scope scope(a);
+        Opt o = make("again");
+        check(a.live() == 1, "arène réutilisée après abandon");
+    }
+    check(a.live() == 0 && a.used() == 0, "libération après abandon");
+}
+
+static void nested(lib::arena &a) {
+    lib::arena inner_arena;
+    {
+        lib::arena_scope outer(a);
+        Opt o1 = make("outer");
+        {
+            lib::arena_scope inner(inner_arena);
+            Opt o2 = make("inner");
+            check(lib::arena::active() == &inner_arena, "arène du scope interne");
+            check(inner_arena.live() == 1 && a.live() == 1, "valeurs du scope interne");
+        }
+        check(lib::arena::active() == &a, "arène du scope externe restaurée");
+        check(a.live() == 1 && inner_arena.live() == 0, "valeurs du scope externe");
+    }
+    check(lib::arena::active() == nullptr, "aucune arène après les scopes");
+}
+
+/* Valeurs créées dans le scope puis détruites par un autre thread :
+ * - pendant le scope (décompte atomique, la région reste celle de l'arène)
+ * - après la fin du scope (région abandonnée, libérée par le dernier thread)
+ */
+static void crossThread(lib::arena &a) {
+    const int n = 64;
+    {
+        lib::arena_scope scope(a);
+        std::vector<Opt> made;
+        for (int i = 0; i < n; i++) {
+            made.push_back(make(std::string(40, 'a' + i % 26)));
+        }
+        std::thread consumer([&]() {
+            std::vector<Opt> owned(std::move(made));
+        });
+        consumer.join();
+        check(a.live() == 0, "libération depuis un autre thread pendant le scope");
+    }
+    check(a.used() == 0, "région réutilisée après libérations distantes");
+
+    std::vector<Opt> escaped;
+    {
+        lib::arena_scope scope(a);
+        for (int i = 0; i < n; i++) {
+            escaped.push_back(make(std::string(40, 'z')));
+        }
+    }
+    std::vector<std::thread> threads;
+    std::vector<Opt> halves[2];
+    for (int i = 0; i < n; i++) {
+        halves[i % 2].push_back(std::move(escaped[i]));
+    }
+    std::vector<long> read(2, 0);
+    for (int t = 0; t < 2; t++) {
+        threads.push_back(std::thread([&, t]() {
+            for (const Opt &o : halves[t]) {
+                read[t] += (long) o.orElseThrow().y.size();
+            }
+            halves[t].clear(); // la dernière valeur libère la région abandonnée
+        }));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    long sizes = read[0] + read[1];
+    check(sizes == 40L * n, "valeurs abandonnées lues depuis d'autres threads");
+}
+
+int main() {
+    lib::arena a;
+    bulkRelease(a);
+    escaping(a);
+    nested(a);
+    crossThread(a);
+    return failures == 0 ? 0 : 1;
+}
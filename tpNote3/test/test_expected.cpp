@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "../include/expected.hpp"
+
+/* lib::expected : la valeur et l'erreur partagent une union (taille du plus grand
+ * des deux, plus un booléen), constexpr pour des types triviaux ; avec std::string,
+ * copie, déplacement et affectation entre une valeur et une erreur (ASan vérifie
+ * que le membre actif est construit et détruit exactement une fois).
+ */
+
+struct Big64 {
+    char bytes[64];
+};
+
+typedef lib::expected<Big64, Big64> BigResult;
+typedef lib::expected<std::string, std::string> Text;
+
+static_assert(sizeof(BigResult) <= sizeof(Big64) + alignof(Big64), "une seule union pour Big64");
+static_assert(sizeof(Text) <= sizeof(std::string) + alignof(std::string), "une seule union pour std::string");
+static_assert(std::is_trivially_copyable<lib::expected<int, long> >::value, "expected de types triviaux");
+static_assert(!std::is_trivially_copyable<Text>::value, "expected de std::string");
+
+constexpr lib::expected<int, long> answer = lib::expected<int, long>::of(42);
+constexpr lib::expected<int, long> failed = lib::expected<int, long>::failure(7L);
+static_assert(answer.isPresent() && *answer == 42 && failed.isEmpty() && failed.error() == 7L, "constexpr");
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("expected : %s incorrect\n", what);
+        failures++;
+    }
+}
+
+int main() {
+    // Chaînes assez longues pour être allouées sur le tas
+    const std::string value(40, 'v');
+    const std::string error(40, 'e');
+
+    Text ok = Text::of(value);
+    Text ko = Text::failure(error);
+    check(ok.isPresent() && *ok == value, "of");
+    check(ko.isEmpty() && ko.error() == error, "failure");
+
+    Text copy(ok);
+    Text copyError(ko);
+    check(*copy == value && copyError.error() == error, "copie");
+
+    // Affectations entre les deux états
+    copy = ko;
+    check(copy.isEmpty() && copy.error() == error, "affectation d'une erreur à une valeur");
+    copy = ok;
+    check(copy.isPresent() && *copy == value, "affectation d'une valeur à une erreur");
+    copy = copy;
+    check(*copy == value, "auto-affectation");
+
+    Text moved(std::move(copy));
+    check(*moved == value, "constructeur par déplacement");
+    moved = Text::failure(error);
+    check(moved.error() == error, "affectation par déplacement d'une erreur");
+    moved = Text::of(value);
+    check(*moved == value, "affectation par déplacement d'une valeur");
+
+    check(std::move(moved).orElseThrow() == value, "orElseThrow sur un temporaire");
+    check(ko.orElse(value) == value, "orElse");
+    check(ok.map([](const std::string &s) { return s.size(); }).orElse(0) == value.size(), "map");
+    check(ko.map([](const std::string &s) { return s.size(); }).error() == error, "map propage l'erreur");
+    check(ok.filter([](const std::string &s) { return s.empty(); }, error).error() == error, "filter");
+    return failures == 0 ? 0 : 1;
+}
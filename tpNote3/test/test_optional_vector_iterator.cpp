@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <type_traits>
+#include "../include/optional_vector.hpp"
+
+/* optional_vector<T>::const_iterator avec les algorithmes standard :
+ * itérateur d'entrée (proxy optional_view), incrément préfixe et postfixe.
+ */
+
+typedef lib::optional_vector<int>::const_iterator iterator;
+
+static_assert(std::is_same<std::iterator_traits<iterator>::iterator_category, std::input_iterator_tag>::value,
+              "operator* retourne un proxy : itérateur d'entrée");
+
+int main() {
+    lib::optional_vector<int> v;
+    for (int i = 0; i < 100; i++) {
+        if (i % 3 == 0) {
+            v.push_back_empty();
+        } else {
+            v.push_back(i);
+        }
+    }
+
+    long present = std::count_if(v.begin(), v.end(), [](const lib::optional_view<int> &o) { return o.isPresent(); });
+    long size = std::distance(v.begin(), v.end());
+    iterator it = v.begin();
+    iterator before = it++;
+    bool postfix = (*before).isEmpty() && (*it).isPresent() && *(*it++) == 1 && *(*it) == 2;
+    if (present != (long) v.countPresent() || size != 100 || !postfix) {
+        std::printf("const_iterator incorrect\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#ifdef TEST_OPT_HPP
+#include "../include/opt.hpp"
+#else
+#include "../include/optional_pt.hpp"
+#endif
+
+/* Sémantique des optionnels propriétaires (optional_pt.hpp, ou opt.hpp avec TEST_OPT_HPP),
+ * compilée avec LIB_OPTIONAL_TRACK_OWNERSHIP=0 et =1 (cf. CMakeLists.txt) :
+ * construction, déplacement, libération, et détection d'un pointeur confié à deux
+ * optionals, qui ne doit avoir lieu qu'avec le registre actif.
+ *
+ * Slot est toujours alloué à la même adresse et son delete ne libère rien :
+ * un pointeur libéré peut être confié à nouveau (même adresse, registre à jour ?) et un
+ * pointeur possédé deux fois peut être « détruit » deux fois sans comportement indéfini.
+ */
+
+struct Slot {
+    int v;
+
+    static void *operator new(std::size_t size);
+
+    static void operator delete(void *p) noexcept;
+};
+
+alignas(Slot) static unsigned char slot_buffer[sizeof(Slot)];
+static int news = 0;
+static int deletes = 0;
+
+void *Slot::operator new(std::size_t size) {
+    if (size != sizeof(Slot) || news != deletes) {
+        std::printf("un seul Slot vivant à la fois\n");
+        std::exit(1);
+    }
+    news++;
+    return slot_buffer;
+}
+
+void Slot::operator delete(void *p) noexcept {
+    if (p == slot_buffer) {
+        deletes++;
+    }
+}
+
+typedef lib::optional<Slot> Opt;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        std::printf("LIB_OPTIONAL_TRACK_OWNERSHIP=%d : %s incorrect\n", LIB_OPTIONAL_TRACK_OWNERSHIP, what);
+        failures++;
+    }
+}
+
+static void construction() {
+    Slot value{5};
+    {
+        Opt o = Opt::of(value);
+        check(o.isPresent() && (*o).v == 5 && o->v == 5, "of");
+        check(o.operator->() != &value, "of copie la valeur");
+        check(Opt::ofNullable(nullptr).isEmpty() && Opt::empty().isEmpty() && !Opt::empty(), "optional vide");
+    }
+    check(news == 1 && deletes == 1, "destruction");
+}
+
+static void move() {
+    {
+        Opt a = Opt::ofNullable(new Slot{7});
+        Opt b(std::move(a));
+        check(a.isEmpty() && b.isPresent() && b->v == 7, "constructeur par déplacement");
+        Opt c = Opt::ofNullable(nullptr);
+        c = std::move(b);
+        check(b.isEmpty() && c.isPresent() && c->v == 7 && deletes == news - 1, "affectation par déplacement");
+    }
+    check(news == deletes, "destruction après déplacement");
+}
+
+// Un pointeur libéré (destruction, ou remplacement par affectation) peut être confié à nouveau
+static void release() {
+    int before = deletes;
+    for (int i = 0; i < 3; i++) {
+        Opt o = Opt::ofNullable(new Slot{i});
+        check(o->v == i, "nouvel optional à la même adresse");
+    }
+    {
+        Opt o = Opt::ofNullable(new Slot{1});
+        o = Opt::ofNullable(nullptr);
+        Opt again = Opt::ofNullable(new Slot{2});
+        check(again->v == 2, "pointeur libéré par affectation");
+    }
+    check(deletes - before == 5, "libérations");
+}
+
+static void doubleOwnership() {
+    bool thrown = false;
+    {
+        Opt a = Opt::ofNullable(new Slot{3});
+        Slot *shared = const_cast<Slot *>(a.operator->());
+        try {
+            Opt b = Opt::ofNullable(shared);
+            check(b->v == 3, "second optional sans registre");
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        check(a.isPresent() && a->v == 3, "le premier optional garde sa valeur");
+    }
+    check(thrown == (LIB_OPTIONAL_TRACK_OWNERSHIP == 1), "détection d'un pointeur possédé deux fois");
+}
+
+int main() {
+    construction();
+    move();
+    release();
+    doubleOwnership();
+    return failures == 0 ? 0 : 1;
+}
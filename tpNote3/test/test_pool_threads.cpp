@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../include/optional.hpp"
+
+/* pool_allocation entre threads : un producteur fabrique des optionals, un consommateur
+ * les détruit. Le consommateur ne fait que libérer : ses emplacements rejoignent sa liste,
+ * qui doit être rendue à la fin du thread. Compilé sous ASan : une liste perdue à la fin
+ * du thread est signalée comme fuite et fait échouer le test.
+ */
+
+struct Payload {
+    long v[24];
+};
+
+typedef lib::optional<Payload, lib::heap_storage<Payload, lib::pool_allocation> > Opt;
+
+int main() {
+    const long n = 1000;
+    for (int round = 0; round < 4; round++) {
+        std::vector<Opt> made;
+        std::thread producer([&]() {
+            for (long i = 0; i < n; i++) {
+                Payload p{};
+                p.v[0] = i;
+                made.push_back(Opt::of(p));
+            }
+        });
+        producer.join();
+
+        long sum = 0;
+        lib::pool_stats stats{};
+        std::thread consumer([&]() {
+            std::vector<Opt> owned(std::move(made));
+            for (const Opt &o : owned) {
+                sum += (*o).v[0];
+            }
+            owned.clear();
+            stats = lib::pool_allocation<Payload>::stats();
+        });
+        consumer.join();
+
+        if (sum != n * (n - 1) / 2) {
+            std::printf("valeurs incorrectes\n");
+            return 1;
+        }
+        // Le consommateur n'a rien alloué dans le pool : tout ce qu'il a libéré est dans sa liste
+        if (stats.misses != 0 || stats.hits != 0 || stats.cached != (std::size_t) n) {
+            std::printf("liste du consommateur incorrecte : %zu emplacements\n", stats.cached);
+            return 1;
+        }
+    }
+    return 0;
+}